@@ -41,10 +41,10 @@ os.chdir( ".." )
 #specify the search paths/dependencies/options for gcc
 include_paths = [ "./AnalyzerSDK/include" ]
 link_paths = [ "./AnalyzerSDK/lib" ]
-link_dependencies = [ "-lAnalyzer" ] #refers to libAnalyzer.dylib or libAnalyzer.so
+link_dependencies = [ "-lAnalyzer", "-pthread" ] #refers to libAnalyzer.dylib or libAnalyzer.so, the export pool uses std::thread
 
-debug_compile_flags = "-O0 -w -c -fpic -g"
-release_compile_flags = "-O3 -w -c -fpic"
+debug_compile_flags = "-O0 -w -c -fpic -g -pthread"
+release_compile_flags = "-O3 -w -c -fpic -pthread"
 
 def run_command(cmd):
     "Display cmd, then run it in a subshell, raise if there's an error"
@@ -3,19 +3,29 @@
 #include <AnalyzerChannelData.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <assert.h>
+#include <algorithm>
+
+//a node answers an ASK_PUB_CMD within this time from the end of the request, never less than the character timeout
+#define LUOS_RESPONSE_TIMEOUT_US 500
+
+//auto baud: number of pulses measured per line, rates the measure is snapped to
+#define LUOS_AUTOBAUD_PULSES 256
+static const U32 LUOS_BIT_RATES[] = { 9600, 19200, 38400, 57600, 115200, 230400, 250000, 460800, 500000, 921600,
+									  1000000, 2000000, 3000000, 4000000 };
 
 LuosAnalyzer::LuosAnalyzer()
 	: Analyzer2(),
 	mSettings(new LuosAnalyzerSettings()),
-	mSimulationInitilized(false)
+	mSimulationInitilized(false),
+	mMeasureBitRate(true),
+	mBitRateMeasured(false),
+	mMeasuredBitRate(0)
 {
 	SetAnalyzerSettings(mSettings.get());
 }
 
 
-U16 crc_val;
-U8 ONE_WIRE;
-
 LuosAnalyzer::~LuosAnalyzer()
 {
 	KillThread();
@@ -28,2033 +38,791 @@ void LuosAnalyzer::SetupResults()
 	mResults->AddChannelBubblesWillAppearOn(mSettings->mTxChannel);
 
 	//if user does not define Rx, we have one_wire config
-	if (mSettings->mRxChannel == UNDEFINED_CHANNEL)
-		ONE_WIRE = 1;
-	else
-	{
-		ONE_WIRE = 0;
+	if (mSettings->mRxChannel != UNDEFINED_CHANNEL)
 		mResults->AddChannelBubblesWillAppearOn(mSettings->mRxChannel);
-	}
 
 }
 
 void LuosAnalyzer::WorkerThread()
 {
-
-
 	mSampleRateHz = GetSampleRate();
 	mTx = GetAnalyzerChannelData(mSettings->mTxChannel);
 
+	//auto baud: this run only measures the bit rate on the beginning of the capture, NeedsRerun then decodes it at this rate
+	if (mSettings->mAutoBaud && mMeasureBitRate) {
+		mMeasuredBitRate = MeasureBitRate();
+		mMeasureBitRate = false;
+		mBitRateMeasured = true;
+		return;
+	}
+
+	//character timing - every offset is relative to the falling edge of the start bit
+	//the bit period is kept with its fraction: at low oversampling a truncated one drifts out of the bit before the stop bit
+	mBitPeriod = (U64(mSampleRateHz) << LUOS_BIT_FRACTION) / mSettings->mBitRate;
+	mSampleOffset = mBitPeriod * mSettings->mSamplePoint / 100;
+	mTimeout = U32(BitSamples(20)); //Timeout = 2*10*(1sec/baudrate)
+	mResponseTimeout = U64(mSampleRateHz) * LUOS_RESPONSE_TIMEOUT_US / 1000000;
+	if (mResponseTimeout < mTimeout)
+		mResponseTimeout = mTimeout;
+
+	//markers kept by the density setting - the bits mark the bytes when they are shown
+	LuosMarkerDensity marker_density = mSettings->mMarkerDensity;
+	mBitMarkers = (marker_density == MARKERS_PER_BIT);
+	mByteMarkers = (marker_density == MARKERS_PER_BYTE);
+	mTimeoutMarkers = (marker_density <= MARKERS_PER_BYTE);
+	mErrorMarkers = (marker_density <= MARKERS_ERRORS_ONLY);
+	mCompactHeader = mSettings->mCompactHeader;
+	mPayloadBytes = mSettings->mPayloadBytes;
+
+	//result updates
+	mUpdatePeriod = mSampleRateHz / mSettings->mUpdateRate;
+	mPendingFrames = 0;
+	mPendingStart = 0;
+	mLastFrameSample = 0;
+	mProgressPeriod = std::chrono::steady_clock::duration(std::chrono::seconds(1)) / mSettings->mUpdateRate;
+	mNextProgress = std::chrono::steady_clock::now();
+
+	//noise: glitch filter and majority vote - the votes are an eighth of a bit away from the sample point
+	mGlitchWidth = mSettings->mGlitchFilter;
+	mVotes = mSettings->mMajorityVote ? 3 : 1;
+	mVoteOffset = 0;
+	if (mSettings->mMajorityVote)
+		mVoteOffset = BitSamples(1) / 8 > 0 ? BitSamples(1) / 8 : 1;
+	mGlitchCount = 0;
+	mFrameGlitchCount = 0;
+
+	//decoder state - a new run restarts from an idle line, looking for the first message
+	mContext.Reset(mSettings->mRxChannel == UNDEFINED_CHANNEL);
+	mMessages.Clear();
+
+	//Initial Position - idle line
 	if (mTx->GetBitState() == BIT_LOW)
 		mTx->AdvanceToNextEdge();
 
-	U32 samples_per_bit = mSampleRateHz / (mSettings->mBitRate);
-	U32 samples_to_first_center_of_first_data_bit = U32(1.5 * double(mSampleRateHz) / double(mSettings->mBitRate)); //advance 1.5 bit
-	U16 bit_counter = 0;    //counter from 0 to 8 - detects the end of a data byte
-	U8 data_byte = 0;       //data_byte entered to crc function
-	U16 size = 0, data_idx = 0, target = 0, source = 0;
-	bool ack = 0, Rx_msg = 0, collision_detection = 0, first_byte = 0, noop = 0;    //bool signals
-	U64 tracking = 0;           //keeps the start and the end of ack timeout period
-	U32 state = 0;							//initialization of state machine
-	//Initial Position of the first bit -- falling edge -- beginning of the start bit
-	mTx->AdvanceToNextEdge();
-	U32 timeout = 20; //Timeout = 2*10*(1sec/baudrate)
+	//the config is resolved once: each decoder only carries the line handling of its own config
+	if (mContext.mOneWire)
+		Decode< OneWirePolicy >();
+	else {
+		//Initial Position in Rx Channel
+		mRx = GetAnalyzerChannelData(mSettings->mRxChannel);
+		if (mRx->GetBitState() == BIT_LOW)
+			mRx->AdvanceToNextEdge();
+		Decode< TxRxPolicy >();
+	}
+}
+
+/*Channel policies of the decoder - everything that depends on the lines used by the config.
+One_wire config: msgs and acks in Tx*/
+class LuosAnalyzer::OneWirePolicy
+{
+public:
+	static bool ReadByte(LuosAnalyzer& analyzer, U64& start_sample, U8& byte)
+	{
+		return analyzer.ReadNextByte(analyzer.mTx, analyzer.mSettings->mTxChannel, AnalyzerResults::Dot, start_sample, byte);
+	}
+
+	static Channel& MessageChannel(LuosAnalyzer& analyzer)
+	{
+		return analyzer.mSettings->mTxChannel;
+	}
 
-	//used for aknowledgement time tracking
+	static void AddMarker(LuosAnalyzer& analyzer, U64 sample, AnalyzerResults::MarkerType marker)
+	{
+		analyzer.mResults->AddMarker(sample, marker, analyzer.mSettings->mTxChannel);
+	}
 
+	static void EndOfMessage(LuosAnalyzer&)
+	{
+	}
 
-	//Process for one_wire config
-	if (ONE_WIRE)
+	static bool AckStarts(LuosAnalyzer& analyzer)
 	{
-		for ( ; ; )
+		return analyzer.mTx->WouldAdvancingCauseTransition(analyzer.mTimeout);
+	}
+
+	static bool ReadAck(LuosAnalyzer& analyzer, U64& start_sample, U8& byte)
+	{
+		return ReadByte(analyzer, start_sample, byte);
+	}
+
+	static void WaitForMessage(LuosAnalyzer& analyzer, bool transmission_error)
+	{
+		AnalyzerChannelData* tx = analyzer.mTx;
+
+		//transmission_error - wait for a timeout period without data before the next msg
+		if (transmission_error)
+			analyzer.SkipToIdle(tx);
+		//the next falling edge is the start bit of a new message
+		if (tx->GetBitState() == BIT_LOW)
+			tx->AdvanceToNextEdge();
+		analyzer.AdvanceToStartBit(tx, analyzer.mSettings->mTxChannel);
+	}
+};
+
+//Tx/Rx config: a msg is sent in Tx and echoed in Rx, or received in Rx only. The ack comes on either line
+class LuosAnalyzer::TxRxPolicy
+{
+public:
+	static bool ReadByte(LuosAnalyzer& analyzer, U64& start_sample, U8& byte)
+	{
+		return analyzer.ReadTxRxByte(analyzer.mContext.mRxMsg, analyzer.mContext.mCollisionDetection, start_sample, byte);
+	}
+
+	static Channel& MessageChannel(LuosAnalyzer& analyzer)
+	{
+		return analyzer.mContext.mRxMsg ? analyzer.mSettings->mRxChannel : analyzer.mSettings->mTxChannel;
+	}
+
+	static void AddMarker(LuosAnalyzer& analyzer, U64 sample, AnalyzerResults::MarkerType marker)
+	{
+		analyzer.mResults->AddMarker(sample, marker, analyzer.mSettings->mTxChannel);
+		analyzer.mResults->AddMarker(sample, marker, analyzer.mSettings->mRxChannel);
+	}
+
+	//the line left behind reaches the end of the message
+	static void EndOfMessage(LuosAnalyzer& analyzer)
+	{
+		SyncLines(analyzer);
+	}
+
+	static bool AckStarts(LuosAnalyzer& analyzer)
+	{
+		return analyzer.mTx->WouldAdvancingCauseTransition(analyzer.mTimeout) || analyzer.mRx->WouldAdvancingCauseTransition(analyzer.mTimeout);
+	}
+
+	//the ack is sent by the target on the first line carrying data
+	static bool ReadAck(LuosAnalyzer& analyzer, U64& start_sample, U8& byte)
+	{
+		bool ack_Rx = !analyzer.mTx->WouldAdvancingCauseTransition(analyzer.mTimeout);
+		bool ack_collision = 0;
+		if (!ack_Rx && analyzer.mRx->WouldAdvancingCauseTransition(analyzer.mTimeout))
+			ack_Rx = analyzer.mRx->GetSampleOfNextEdge() < analyzer.mTx->GetSampleOfNextEdge();
+		return analyzer.ReadTxRxByte(ack_Rx, ack_collision, start_sample, byte);
+	}
+
+	static void WaitForMessage(LuosAnalyzer& analyzer, bool transmission_error)
+	{
+		AnalyzerChannelData* tx = analyzer.mTx;
+		AnalyzerChannelData* rx = analyzer.mRx;
+
+		//both lines restart from the same point
+		SyncLines(analyzer);
+
+		//transmission_error - wait for a timeout period without data on both lines: each busy line skips to its next gap
+		while (transmission_error)
 		{
-			CheckIfThreadShouldExit();      //kill thread in case of infinite loop
-			U64 label = 0, data = 0;													//frames' info
-			U64 value = 0, value_byte = 0;								//data & crc calculation helpers
-			U8 dd = 0;																			//
-			U64 starting_sample = mTx->GetSampleNumber();	//points to the beginning of a frame
-			bool transmission_error = 0, noop = 0;						//reset and collision notifiers
-
-			//state machine for the transmission-reception of a message
-			switch (state) {
-			case PROTOCOL:
-			{
-                //reset values - beginning of a new msg
-                data_byte = 0;
-                data_idx = 0;
-                crc_val = 0xFFFF;     //initial value of crc
-                
-				mTx->Advance(samples_to_first_center_of_first_data_bit);    //samples to the center of the first bit
-				//if there's no edge for the duration of timeout -> reset
-				if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-					state = WAIT;
-					mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);    //error
-					mTx->AdvanceToNextEdge();   //skip no data period
-					noop = 1;               //no frame will be added
-					break;
-				}
-				starting_sample += samples_per_bit; 	//skip the start bit
-				for (U32 i = 0; i < 4; i++)
-				{
-					//if there's no edge for the duration of timeout -> reset
-					if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-						transmission_error = 1; //this variable will break this state
-						mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel); //error
-						mTx->AdvanceToNextEdge();   //skip the no data period
-						break;
-					}
-					//let's put a dot exactly where we sample this bit:
-					mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mTxChannel);
-					bit_counter++;
-
-					//store the 4 bits protocol value (lsb transformation)
-					if (mTx->GetBitState() == BIT_HIGH) {
-						value = 1;
-						for (U32 j = 0; j < i; j++) {
-							value *= 2;
-						}
-						data += value;
-						data_byte += (uint8_t)value;
-					}
-					label = 'PROT';
-					mTx->Advance(samples_per_bit);
-				}
-				//reset, because we found a big period with no new data
-				if (transmission_error) {
-					state = WAIT;
-					transmission_error = 0;
-					noop = 1;
-					break;
-				}
-				first_byte = 1;     //this variable shows that the next four bits will be taken into consideration for the crc calculation of the first byte
-				state = TARGET;     //next state
-				break;
-			}
-			case TARGET:
-			{
-				starting_sample -= samples_per_bit / 2;     //new frame's position
-
-				//if there's no edge for the duration of timeout -> reset
-				if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-					state = WAIT;
-					mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);    //Transmission Error - Collision
-					mTx->AdvanceToNextEdge();   //skip the no data period
-					noop = 1;                   //no new frame will be added
-					break;
-				}
-				for (U32 i = 0; i < 12; i++)
-				{
-					//if there's no edge for the duration of timeout -> reset
-					if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-						transmission_error = 1;
-						mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);    //Transmission Error - Collision
-						mTx->AdvanceToNextEdge();       //skip the no data period
-						break;
-					}
-					//if 8 bits are sampled, skip the stop and start bit
-					if (bit_counter == 8) {
-						dd = dd << 4;
-						data_byte += dd;            //data_byte contains now the 4 bits of protocol and 4 bits of target for the crc comp.
-						ComputeCRC(data_byte);
-						mTx->AdvanceToNextEdge();   //skip stop and start bit
-						mTx->Advance(samples_to_first_center_of_first_data_bit);    //sample to the center of the next data bit
-						data_byte = 0;      //reset data byte values
-						dd = 0;
-						bit_counter = 0;
-						first_byte = 0;
-					}
-					//let's put a dot exactly where we sample this bit:
-                    mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mTxChannel);
-					bit_counter++;
-
-					//target value calculation + lsb first inversion
-					if (mTx->GetBitState() == BIT_HIGH) {
-						value = 1;
-						value_byte = 1;
-						for (U32 j = 0; j < i; j++) {
-							value *= 2;
-						}
-						if (!first_byte) {
-							for (U32 j = 0; j < i - 4; j++) {
-								value_byte *= 2;
-							}
-							dd += (uint8_t)value_byte;
-						}
-						else {
-							dd += (uint8_t)value;
-						}
-						data += value;
-					}
-					label = 'TRGT';
-					mTx->Advance(samples_per_bit);          //next bit
-				}
-                //reset, because we found a long period with no new data
-				if (transmission_error) {
-					state = WAIT;
-					transmission_error = 0;
-					noop = 1;       //no frame will be added
-					break;
-				}
-				data_byte = dd;
-				ComputeCRC(data_byte);  //crc comp. of second data byte
-				data_byte = 0;
-				state = TARGET_MODE;    //next state
-				break;
-			}
-			case TARGET_MODE:
-			{
-				//if there's no edge for the duration of timeout -> reset
-				if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-					state = WAIT;
-					mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);    //transmission error - collision
-					mTx->AdvanceToNextEdge();   //skip the no data period
-					noop = 1;                   //no new frame
-					break;
-				}
-				starting_sample += (uint64_t)samples_per_bit * 2 - samples_per_bit / 2;			//skip start & stop bit
-				mTx->AdvanceToNextEdge();
-				mTx->Advance(samples_to_first_center_of_first_data_bit);                        //sample to the center of the next data bit
-
-				//if there's no edge for the duration of timeout -> reset
-				if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-					state = WAIT;
-					mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-					mTx->AdvanceToNextEdge();
-					noop = 1;
-					break;
-				}
-				bit_counter = 0;
-				for (U32 i = 0; i < 4; i++)
-				{
-					//if there's no edge for the duration of timeout -> reset
-					if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-						transmission_error = 1;
-						mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						mTx->AdvanceToNextEdge();
-						break;
-					}
-
-					//let's put a dot exactly where we sample this bit:
-					mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mTxChannel);
-					bit_counter++;
-					//target mode data calculation - lsb first inversion
-					if (mTx->GetBitState() == BIT_HIGH) {
-						value = 1;
-						for (U32 j = 0; j < i; j++) {
-
-							value *= 2;
-						}
-						data += value;
-						data_byte += (uint8_t)value;
-					}
-					label = 'MODE';
-					//sample next bit
-					mTx->Advance(samples_per_bit);
-
-				}
-
-				// if mode = IDACK | NODEIDACK -> ack notifier is ON
-				if (data == 1 || data == 6) {
-					ack = 1;
-				}
-				else {
-					ack = 0;
-				}
-
-				//reset
-				if (transmission_error) {
-					state = WAIT;
-					transmission_error = 0;
-					noop = 1;
-					break;
-				}
-				state = SOURCE;
-				first_byte = 1;
-				break;
-			}
-			case SOURCE:
-			{
-				starting_sample -= samples_per_bit / 2;
-
-				//if there's no edge for the duration of timeout -> reset
-				if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-					state = WAIT;
-					mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-					mTx->AdvanceToNextEdge();
-					noop = 1;
-					break;
-				}
-				for (U32 i = 0; i < 12; i++)
-				{
-					//if there's no edge for the duration of timeout -> reset
-					if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-						transmission_error = 1;
-						mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						mTx->AdvanceToNextEdge();
-						break;
-					}
-					//when 8 bits sampled -> skip stop and start bit
-					if (bit_counter == 8) {
-						dd = dd << 4;
-						data_byte += dd;
-						ComputeCRC(data_byte);
-						mTx->AdvanceToNextEdge();
-						mTx->Advance(samples_to_first_center_of_first_data_bit);
-						bit_counter = 0;
-						data_byte = 0;
-						dd = 0;
-						first_byte = 0;
-					}
-					//let's put a dot exactly where we sample this bit:
-					mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mTxChannel);
-					bit_counter++;
-
-					//source value computation - lsb first inversion
-					if (mTx->GetBitState() == BIT_HIGH) {
-						value = 1;
-						value_byte = 1;
-						for (U32 j = 0; j < i; j++) {
-							value *= 2;
-						}
-						if (!first_byte)
-						{
-							for (U32 j = 0; j < i - 4; j++)
-							{
-								value_byte *= 2;
-							}
-							dd += (uint8_t)value_byte;
-						}
-						else {
-							dd += (uint8_t)value;
-						}
-						data += value;
-					}
-					label = 'SRC';
-					mTx->Advance(samples_per_bit);
-
-				}
-                //if there's no edge for the duration of timeout -> reset
-				if (transmission_error) {
-					state = WAIT;
-					transmission_error = 0;
-					bit_counter = 0;
-					noop = 1;
-					break;
-				}
-				data_byte = dd;
-				ComputeCRC(data_byte);
-				data_byte = 0;
-				source = (uint16_t)data;
-				state = CMD;
-				break;
-			}
-			case CMD:
-			{
-				starting_sample += (uint64_t)samples_per_bit * 2 - samples_per_bit / 2;		//skip start & stop bit
-				//if there's no edge for the duration of timeout -> reset
-				if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-					state = WAIT;
-					mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-					mTx->AdvanceToNextEdge();
-					noop = 1;
-					break;
-				}
-				mTx->AdvanceToNextEdge();
-				mTx->Advance(samples_to_first_center_of_first_data_bit);
-
-				//if there's no edge for the duration of timeout -> reset
-				if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-					state = WAIT;
-					mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-					mTx->AdvanceToNextEdge();
-					noop = 1;
-					break;
-				}
-				bit_counter = 0;
-				for (U32 i = 0; i < 8; i++)
-				{
-					//if there's no edge for the duration of timeout -> reset
-					if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-						transmission_error = 1;
-						mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						mTx->AdvanceToNextEdge();
-						break;
-					}
-					//let's put a dot exactly where we sample this bit:
-					mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mTxChannel);
-					bit_counter++;
-					//cmd computation - lsb first inversion
-					if (mTx->GetBitState() == BIT_HIGH) {
-						value = 1;
-						for (U32 j = 0; j < i; j++) {
-							value *= 2;
-						}
-						data += value;
-						data_byte += (uint8_t)value;
-					}
-					label = 'CMD';
-					mTx->Advance(samples_per_bit);
-
-				}
-				//reset
-				if (transmission_error) {
-					state = WAIT;
-					transmission_error = 0;
-					noop = 1;
-					break;
-				}
-				state = SIZE;
-				first_byte = 1;
-				ComputeCRC(data_byte);
-				data_byte = 0;
+			analyzer.CheckIfThreadShouldExit();
+			if (!tx->WouldAdvancingCauseTransition(analyzer.mTimeout) && !rx->WouldAdvancingCauseTransition(analyzer.mTimeout))
 				break;
-			}
-			case SIZE:
-			{
-				//if there's no edge for the duration of timeout -> reset
-				if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-					state = WAIT;
-					mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-					mTx->AdvanceToNextEdge();
-					noop = 1;
-					break;
-				}
-				starting_sample += (uint64_t)samples_per_bit * 2 - samples_per_bit / 2;
-				mTx->AdvanceToNextEdge();
-				mTx->Advance(samples_to_first_center_of_first_data_bit);
-				//if there's no edge for the duration of timeout -> reset
-				if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-					state = WAIT;
-					mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-					mTx->AdvanceToNextEdge();
-					noop = 1;
-					break;
-				}
-				bit_counter = 0;
-				for (U32 i = 0; i < 16; i++)
-				{
-					//if there's no edge for the duration of timeout -> reset
-					if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-						transmission_error = 1;
-						mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						mTx->AdvanceToNextEdge();
-						break;
-					}
-					//when 8 bits are sampled ->skip stop and start bit
-					if (bit_counter == 8) {
-						ComputeCRC(data_byte);
-						mTx->AdvanceToNextEdge();
-						mTx->Advance(samples_to_first_center_of_first_data_bit);
-						bit_counter = 0;
-						data_byte = 0;
-						first_byte = 0;
-					}
-					//let's put a dot exactly where we sample this bit:
-					mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mTxChannel);
-					bit_counter++;
-					if (mTx->GetBitState() == BIT_HIGH) {
-						value = 1;
-						value_byte = 1;
-						for (U32 j = 0; j < i; j++) {
-
-							value *= 2;
-						}
-						if (!first_byte) {
-							for (U32 j = 0; j < i - 8; j++) {
-
-								value_byte *= 2;
-							}
-							data_byte += (uint8_t)value_byte;
-						}
-						else {
-							data_byte += (uint8_t)value;
-						}
-						data += value;
-					}
-					label = 'SIZE';
-					mTx->Advance(samples_per_bit);
-				}
-				//reset
-				if (transmission_error) {
-					state = WAIT;
-					transmission_error = 0;
-					noop = 1;
-					break;
-				}
-				size = data;
-				ComputeCRC(data_byte);
-				if (size == 0) state = CRC;				//if no data -> go to crc state
-				else state = DATA;
-				data_byte = 0;
-				break;
-			}
-			case DATA:
-			{
-				//if there's no edge for the duration of timeout -> reset
-				if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-					state = WAIT;
-					mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-					mTx->AdvanceToNextEdge();
-					noop = 1;
-					break;
-				}
-				starting_sample += (uint64_t)samples_per_bit * 2 - samples_per_bit / 2;
-				mTx->AdvanceToNextEdge();
-				mTx->Advance(samples_to_first_center_of_first_data_bit);
-				//if there's no edge for the duration of timeout -> reset
-				if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-					state = WAIT;
-					noop = 1;
-					mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-					mTx->AdvanceToNextEdge();
-					data_idx = 0;
-					break;
-				}
-
-				for (U32 i = 0; i < 8; i++)
-				{
-					//if there's no edge for the duration of timeout -> reset
-					if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-						transmission_error = 1;
-						mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						mTx->AdvanceToNextEdge();
-						break;
-					}
-					mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mTxChannel);
-
-					//data computation - lsb first inversion
-					if (mTx->GetBitState() == BIT_HIGH)
-					{
-						value = 1;
-						for (U32 j = 0; j < i; j++)
-							value *= 2;
-
-						data += value;
-						data_byte += (uint8_t)value;
-					}
-					label = data_idx;
-					mTx->Advance(samples_per_bit);
-				}
-				//reset
-				if (transmission_error) {
-					state = WAIT;
-					transmission_error = 0;
-					noop = 1;
-					data_idx = 0;
+			analyzer.SkipToIdle(tx);
+			analyzer.SkipToIdle(rx);
+			SyncLines(analyzer);
+		}
+
+		//Initialization of the next message - the first start bit found gives the line carrying the msg
+		for ( ; ; )
+		{
+			if (tx->GetBitState() == BIT_LOW)
+				tx->AdvanceToNextEdge();
+			if (rx->GetBitState() == BIT_LOW)
+				rx->AdvanceToNextEdge();
+			U64 tx_edge = tx->GetSampleOfNextEdge();
+			U64 rx_edge = rx->GetSampleOfNextEdge();
+			if (rx_edge < tx_edge) {			//data found in Rx first -> Rx msg
+				analyzer.mContext.mCollisionDetection = (tx_edge - rx_edge < analyzer.mTimeout);		//Data found in Tx also -> collision
+				analyzer.mContext.mRxMsg = 1;
+				rx->AdvanceToNextEdge();
+				if (!analyzer.SkipGlitch(rx, analyzer.mSettings->mRxChannel))
 					break;
-				}
-				ComputeCRC(data_byte);
-				data_idx++;
-				data_byte = 0;
-				//if data finished -> go to next state, else continue with data comp
-				if (data_idx == size || data_idx == 128) {
-					state = CRC;
-					data_idx = 0;
-				}
-				break;
 			}
-			case CRC:
-			{
-				//if there's no edge for the duration of timeout -> reset
-				if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-					state = WAIT;
-					mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-					mTx->AdvanceToNextEdge();
-					noop = 1;
+			else {
+				analyzer.mContext.mCollisionDetection = 0;
+				analyzer.mContext.mRxMsg = 0;
+				tx->AdvanceToNextEdge();
+				if (!analyzer.SkipGlitch(tx, analyzer.mSettings->mTxChannel))
 					break;
-				}
-				starting_sample += (uint64_t)samples_per_bit * 2 - samples_per_bit / 2;
-				mTx->AdvanceToNextEdge();
-				mTx->Advance(samples_to_first_center_of_first_data_bit);
-				bit_counter = 0;
-				for (U32 i = 0; i < 16; i++)
-				{
-					if (bit_counter == 8)  //if 8 bits sampled -> skip stop and start bit
-					{
-						tracking = mTx->GetSampleNumber();
-						mTx->AdvanceToNextEdge();
-						mTx->Advance(samples_to_first_center_of_first_data_bit);
-						bit_counter = 0;
-					}
-					//crc computation - lsb first inversion
-					if (mTx->GetBitState() == BIT_HIGH)
-					{
-						value = 1;
-						for (U32 j = 0; j < i; j++) {
-
-							value *= 2;
-						}
-						data += value;
-					}
-
-					if ((i == 15))
-					{
-						//Last bit of CRC - Timeout timer is on!
-                        if (crc_val!=data)
-                            mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-                        else
-                            mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mTxChannel);
-						tracking = mTx->GetSampleNumber() + samples_per_bit / 2;
-						mResults->AddMarker(tracking, AnalyzerResults::Start, mSettings->mTxChannel);
-                        
-                        tracking += timeout * samples_per_bit;
-                        if (ack)
-                        {
-                            if (mTx->WouldAdvancingCauseTransition(timeout*samples_per_bit))
-                                state = ACK;
-                        
-                            else {
-                                mResults->AddMarker(tracking, AnalyzerResults::ErrorX, mSettings->mTxChannel);
-                                state=WAIT;
-                            }
-                        }
-                        else {
-                            mResults->AddMarker(tracking, AnalyzerResults::Start, mSettings->mTxChannel);
-                        }
-					}
-					else
-						mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mTxChannel);
-
-					bit_counter++;
-					mTx->Advance(samples_per_bit);
-				}
-
-				//crc sent compared to crc computed - if not equal, data corrupted
-				if (data == crc_val)
-					label = 'CRC';
-				else {
-					label = 'NOT';
-					transmission_error = 1;
-				}
-				if (transmission_error) {
-					state = WAIT;
-					data_idx = 0;
-					break;
-				}
-                if (ack == 0)
-                    state = WAIT;
-				bit_counter = 0;
-				break;
-			}
-			case ACK:
-			{
-				//we enter this case after the wait state and only if we find and ack before timeout
-                mTx->AdvanceToNextEdge();
-				mTx->Advance(samples_to_first_center_of_first_data_bit);
-                starting_sample = mTx->GetSampleNumber() - (samples_per_bit/2);
-				for (U32 i = 0; i < 8; i++)
-                {
-					mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mTxChannel);
-					//ack computation - lsb first inversion
-					if (mTx->GetBitState() == BIT_HIGH) {
-						value = 1;
-						for (U32 j = 0; j < i; j++)
-							value *= 2;
-
-						data += value;
-					}
-					label = 'ACK';
-					mTx->Advance(samples_per_bit);
-				}
-				state = WAIT;
-				ack = 0;
-                mResults->AddMarker(tracking, AnalyzerResults::Stop, mSettings->mTxChannel);
-                tracking = mTx->GetSampleNumber();
-                tracking += timeout*samples_per_bit - samples_per_bit/2;
-                mResults->AddMarker(tracking, AnalyzerResults::Start, mSettings->mTxChannel);
-				break;
-			}
-			default:
-			{
-				state = WAIT;
-				break;
-			}
-			}
-			if (noop) ack = 0;
-
-			//Set Frame Data.
-			Frame frame;
-			frame.mData1 = label;
-			frame.mData2 = data;
-			frame.mFlags = 0;
-			frame.mStartingSampleInclusive = starting_sample;
-			frame.mEndingSampleInclusive = mTx->GetSampleNumber() - samples_per_bit / 2;
-
-			//send a frame only if there is not a transmission_error
-			if (!noop) {
-				mResults->AddFrame(frame);
-				mResults->CommitResults();
-				ReportProgress(frame.mEndingSampleInclusive);
-			}
-			//wait state is used when we wait for an ack or for a new message
-			if (state == WAIT)
-			{
-				while (1)
-				{
-					CheckIfThreadShouldExit();      //kill thread in case of infinite loop
-					bit_counter = 0;
-					//Case where CRC was not good - in wait state until it finds a new msg - timeout period without a new msg
-					if (transmission_error)
-					{
-						if (mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-							mTx->AdvanceToNextEdge();
-							continue;
-						}
-						mTx->AdvanceToNextEdge();
-						state = PROTOCOL;
-						ack = 0;
-						break;
-					}
-					//when timeout ends after the end of the ack transmission
-					if (!noop)
-						mTx->AdvanceToNextEdge();
-
-					starting_sample += samples_per_bit;
-					if (mTx->GetBitState() == BIT_LOW)
-					{
-						state = PROTOCOL;
-						break;
-					}
-				}
 			}
 		}
 	}
-	else {																								//Rx and Tx Channels
 
-		//Initial Position in Rx Channel
-		mRx = GetAnalyzerChannelData(mSettings->mRxChannel);
-		if (mRx->GetBitState() == BIT_LOW)
-			mRx->AdvanceToNextEdge();
-		mRx->AdvanceToNextEdge();
-		mRx->Advance(samples_to_first_center_of_first_data_bit);
+protected:
+	static void SyncLines(LuosAnalyzer& analyzer)
+	{
+		if (analyzer.mRx->GetSampleNumber() > analyzer.mTx->GetSampleNumber())
+			analyzer.mTx->AdvanceToAbsPosition(analyzer.mRx->GetSampleNumber());
+		else
+			analyzer.mRx->AdvanceToAbsPosition(analyzer.mTx->GetSampleNumber());
+	}
+};
 
-		if (mRx->GetSampleNumber() < mTx->GetSampleNumber()) {      //if Rx earlier than Tx -> Rx_msg
-			if (mTx->GetSampleNumber() - mRx->GetSampleNumber() < timeout * samples_per_bit)    //if Tx close to Rx ->collision detection
-				collision_detection = 1;
-			Rx_msg = 1;
-		}
-		else Rx_msg = 0;
+//Decoder core - state machine for the transmission-reception of a message, the lines are handled by ChannelPolicy
+template< class ChannelPolicy >
+void LuosAnalyzer::Decode()
+{
+	for ( ; ; )
+	{
+		CheckIfThreadShouldExit();      //kill thread in case of infinite loop
+		U64 label = 0, data = 0;                        //frames' info
+		U64 starting_sample = 0, ending_sample = 0;     //frames' position
+		bool transmission_error = 0, noop = 0;          //reset and no frame notifiers
 
-		for ( ; ; )
+		switch (mContext.mState) {
+		case HEADER:
 		{
-			CheckIfThreadShouldExit();      //kill thread in case of infinite loop
-			U64 label = 0, data = 0, received_data = 0;							//frames' info
-			U64 value = 0, value_byte = 0;										//data & crc calculation helpers
-			U8 dd = 0, dd2 = 0;																		//
-			bool transmission_error = 0;					//reset and collision notifiers
-			U64 starting_sample = 0;														//points to the beginning of a frame
-
-			//if Rx is 1 then msg in Rx, else msg in Tx
-
-			//find the beginning of a frame, depending on the channel we have the msg
-			if (Rx_msg)
-				starting_sample = mRx->GetSampleNumber();
-			else
-				starting_sample = mTx->GetSampleNumber();
-
-			switch (state) {
-			case PROTOCOL:
-			{
-                //reset of the values - new msg initialization
-				data_byte = 0;
-				data_idx = 0;
-				noop = 0;
-				ack = 0;
-				bit_counter = 0;
-				crc_val = 0xFFFF;											//crc initial value
-				if (!Rx_msg) {	//when data exist in channel Tx, move the Tx pointer
-					mTx->Advance(samples_to_first_center_of_first_data_bit);
-					starting_sample += samples_per_bit;
-					if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {   //long period with no data?->reset
-						transmission_error = 1;
-                        mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                        mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						noop = 1;       //no new frame will be added
-						state = WAIT;
-						break;
-					}
-				}
-				else {
-					starting_sample -= samples_per_bit / 2; //skip the start bit
-					if (!mRx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) { //long period with no data?->reset
-						transmission_error = 1;
-                        mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                        mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						noop = 1;   //no new frame will be added
-						state = WAIT;
-						break;
-					}
-				}
-				for (U32 i = 0; i < 4; i++)
-				{
-					if (Rx_msg)				//msg in Rx
-					{
-						//if the time between the current moment and the last transition is more than timeout -> reset
-						if (!mRx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-							transmission_error = 1;
-                            mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                            mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-							break;
-						}
-						mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mRxChannel);
-
-						if (collision_detection)			//add error X
-							mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						//protocol value computation -> lsb first inversion
-						if (mRx->GetBitState() == BIT_HIGH) {
-							value = 1;
-							for (U32 j = 0; j < i; j++) {
-								value *= 2;
-							}
-							data += value;
-							data_byte += (uint8_t)value;
-						}
-						label = 'PROT';
-						mRx->Advance(samples_per_bit);  //go to next data bit
-					}
-					else {
-						//if the time between the current moment and the last transition is more than timeout -> reset
-						if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-							transmission_error = 1;
-                            mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                            mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-							break;
-						}
-						//let's put a dot exactly where we sample this bit:
-						mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mTxChannel);
-						//square - bit received by Rx
-						mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::Square, mSettings->mRxChannel);
-						//protocol value computation - lsb first inversion
-						if (mTx->GetBitState() == BIT_HIGH) {
-							value = 1;
-							for (U32 j = 0; j < i; j++) {
-								value *= 2;
-							}
-							data += value;
-							data_byte += (uint8_t)value;
-						}
-						//protocol value in Rx channel - lsb first inversion    -- to check collision
-						if (mRx->GetBitState() == BIT_HIGH) {
-							value = 1;
-							for (U32 j = 0; j < i; j++) {
-								value *= 2;
-							}
-							received_data += value;
-						}
-						label = 'PROT';
-						mTx->Advance(samples_per_bit);
-						mRx->Advance(samples_per_bit);
-					}
-					bit_counter++;
-				}
-				//reset if long period with no new data
-				if (transmission_error) {
-					state = WAIT;
-					noop = 1;
-					bit_counter = 0;
-					break;
-				}
-				//if data in Tx and Rx not equal -> collision detection
-				if (!Rx_msg && received_data != data) {
-					collision_detection = 1;
-					Rx_msg = 1;
-					data_byte = (uint8_t)received_data;
-				}
-				first_byte = 1;
-				state = TARGET;
+			U32 byte_idx = mContext.mMessageSize;
+			if (!ChannelPolicy::ReadByte(*this, mContext.mHeaderStart[byte_idx], mContext.mDataByte)) {
+				//a compact header is only sent whole - the fields already received are shown one by one
+				if (mCompactHeader)
+					AddHeaderFrames(0, byte_idx);
+				transmission_error = 1; noop = 1; mContext.mState = WAIT;
 				break;
 			}
-			case TARGET:
-			{
-				starting_sample -= samples_per_bit / 2;
-
-				for (U32 i = 0; i < 12; i++)
-				{
-					//if 8 bits are sampled, skip the stop and start bit
-					if (bit_counter == 8) {
-						dd = dd << 4;
-						data_byte += dd;
-						ComputeCRC(data_byte);
-						if (!Rx_msg)				//when data exist in channel Tx, move the Tx pointer
-						{
-							if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-								transmission_error = 1;
-                                mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                                mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-								break;
-							}
-							mTx->AdvanceToNextEdge();
-							mTx->Advance(samples_to_first_center_of_first_data_bit);
-						}
-						if (!mRx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-							transmission_error = 1;
-                            mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                            mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-							break;
-						}
-						mRx->AdvanceToNextEdge();
-						mRx->Advance(samples_to_first_center_of_first_data_bit);
-						data_byte = 0;
-						dd = 0;
-						bit_counter = 0;
-						first_byte = 0;
-					}
-
-					if (Rx_msg) {
-						//if the time between the current moment and the last transition is more than timeout -> reset
-						if (!mRx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-							transmission_error = 1;
-                            mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                            mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-							break;
-						}
-						if (collision_detection)		//if collision ad an errorX to Tx
-							mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mRxChannel);
-					}
-					else
-					{
-						//if the time between the current moment and the last transition is more than timeout -> reset
-						if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-							transmission_error = 1;
-                            mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                            mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-							break;
-						}
-						mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mTxChannel);
-						mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::Square, mSettings->mRxChannel);
-					}
-					bit_counter++;
-					if (Rx_msg)
-					{
-						//calculate target id - lsb first inversion
-						if (mRx->GetBitState() == BIT_HIGH) {
-							value = 1;
-							value_byte = 1;
-							for (U32 j = 0; j < i; j++) {
-								value *= 2;
-							}
-							if (!first_byte) {
-								for (U32 j = 0; j < i - 4; j++) {
-									value_byte *= 2;
-								}
-								dd += (uint8_t)value_byte;
-							}
-							else {
-								dd += (uint8_t)value;
-							}
-							data += value;
-						}
-					}
-					else
-					{
-						//calculate target id in Tx - lsb first inversion
-						if (mTx->GetBitState() == BIT_HIGH) {
-							value = 1;
-							value_byte = 1;
-							for (U32 j = 0; j < i; j++) {
-								value *= 2;
-							}
-							if (!first_byte) {
-								for (U32 j = 0; j < i - 4; j++) {
-									value_byte *= 2;
-								}
-								dd += (uint8_t)value_byte;
-							}
-							else {
-								dd += (uint8_t)value;
-							}
-							data += value;
-						}
-						//calculate target id in Rx - lsb first inversion
-						if (mRx->GetBitState() == BIT_HIGH) {
-							value = 1;
-							value_byte = 1;
-							for (U32 j = 0; j < i; j++) {
-								value *= 2;
-							}
-							if (!first_byte) {
-								for (U32 j = 0; j < i - 4; j++) {
-									value_byte *= 2;
-								}
-								dd2 += (uint8_t)value_byte;
-							}
-							else {
-								dd2 += (uint8_t)value;
-							}
-							received_data += value;
-						}
-					}
-					//if Rx and Tx data are not equal -> collision detection
-					//after a collision detection, the data of Rx are monitored
-					if (!Rx_msg && received_data != data) {
-						collision_detection = 1;
-						Rx_msg = 1;
-						data = received_data;
-						dd = dd2;
-					}
-					label = 'TRGT';
-					if (!Rx_msg)
-						mTx->Advance(samples_per_bit);
-					mRx->Advance(samples_per_bit);
-				}
-				//reset
-				if (transmission_error) {
-					state = WAIT;
-					//transmission_error = 0;
-					noop = 1;
-					break;
-				}
-				data_byte = dd;
-				ComputeCRC(data_byte);
-				target = (uint16_t)data;
-				data_byte = 0;
-				state = TARGET_MODE;
+			mContext.mMessage[mContext.mMessageSize++] = mContext.mDataByte;
+			mContext.mHeader |= (U64)mContext.mDataByte << (8 * byte_idx);
+			noop = 1;       //frames sent here
+			if (!mCompactHeader)
+				AddHeaderFrames(byte_idx, byte_idx + 1);
+			if (mContext.mMessageSize < LUOS_HEADER_SIZE)
 				break;
-			}
-			case TARGET_MODE:
-			{
-				starting_sample += (uint64_t)samples_per_bit * 2 - samples_per_bit / 2;
-				if (!Rx_msg)							//when data exist in channel Tx, move the Tx pointer
-				{
-
-					if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-						state = WAIT;
-                        mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                        mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						noop = 1;
-						transmission_error = 1;
-						break;
-					}
-					mTx->AdvanceToNextEdge();
-					mTx->Advance(samples_to_first_center_of_first_data_bit);
-				}
-
-				if (Rx_msg) {
-					if (!mRx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-						transmission_error = 1;
-                        mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                        mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						state = WAIT;
-						noop = 1;
-						break;
-					}
-				}
-				mRx->AdvanceToNextEdge();
-				mRx->Advance(samples_to_first_center_of_first_data_bit);
-				bit_counter = 0;
-				for (U32 i = 0; i < 4; i++)
-				{
-					bit_counter++;
-					if (Rx_msg)		//msg in Rx channel
-					{
-						//if the time between the current moment and the last transition is more than timeout -> reset
-						if (!mRx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-							transmission_error = 1;
-                            mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                            mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-							break;
-						}
-						if (collision_detection)
-						{
-							mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						}
-						mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mRxChannel);
-						//Target mode computation - lsb first inversion
-						if (mRx->GetBitState() == BIT_HIGH) {
-							value = 1;
-							for (U32 j = 0; j < i; j++) {
-
-								value *= 2;
-							}
-							data += value;
-							data_byte += (uint8_t)value;
-						}
-						label = 'MODE';
-						mRx->Advance(samples_per_bit);
-					}
-					else
-					{
-						//if the time between the current moment and the last transition is more than timeout -> reset
-						if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-							transmission_error = 1;
-                            mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                            mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-							break;
-						}
-						mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mTxChannel);
-						mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::Square, mSettings->mRxChannel);
-						//Target mode computation - lsb first inversion
-						if (mTx->GetBitState() == BIT_HIGH) {
-							value = 1;
-							for (U32 j = 0; j < i; j++) {
-
-								value *= 2;
-							}
-							data += value;
-							data_byte += (uint8_t)value;
-						}
-						//Target mode received in Rx channel
-						if (mRx->GetBitState() == BIT_HIGH) {
-							value = 1;
-							for (U32 j = 0; j < i; j++) {
-								value *= 2;
-							}
-							received_data += value;
-						}
-						label = 'MODE';
-						mTx->Advance(samples_per_bit);
-						mRx->Advance(samples_per_bit);
-					}
-				}
-				//reset
-				if (transmission_error) {
-					state = WAIT;
-					noop = 1;
-					bit_counter = 0;
-					break;
-				}
-				if (!Rx_msg && received_data != data) {
-					collision_detection = 1;
-					Rx_msg = 1;
-					data_byte = (uint8_t)received_data;
-					data = received_data;
-				}
-				//when target = IDACK | NODEIDACK, ack notifier is ON
-				if (data == 1 || data == 6) {
-					ack = 1;
-				}
-				state = SOURCE;
-				first_byte = 1;
+			if (mCompactHeader)
+				AddFieldFrame(mContext.mHeader, 0, mContext.mHeaderStart[0] + BitSamples(1),
+					mContext.mHeaderStart[LUOS_HEADER_SIZE - 1] + BitSamples(9), HEADER_FRAME);
+
+			//whole header received
+			U64 mode = LUOS_HEADER_LAYOUT[HEADER_MODE].Extract(mContext.mHeader);
+			mContext.mTarget = (U16)LUOS_HEADER_LAYOUT[HEADER_TARGET].Extract(mContext.mHeader);
+			mContext.mSource = (U16)LUOS_HEADER_LAYOUT[HEADER_SOURCE].Extract(mContext.mHeader);
+			mContext.mSize = (U16)LUOS_HEADER_LAYOUT[HEADER_SIZE].Extract(mContext.mHeader);
+			// if mode = IDACK | NODEIDACK -> ack notifier is ON
+			mContext.mAck = (mode == MODE_IDACK || mode == MODE_NODEIDACK);
+			if (mContext.mSize == 0) mContext.mState = CRC;				//if no data -> go to crc state
+			else mContext.mState = DATA;
+			break;
+		}
+		case DATA:
+		{
+			if (!ChannelPolicy::ReadByte(*this, mContext.mByteStart, mContext.mDataByte)) {
+				//the bytes of an unfinished payload frame are still shown
+				if (mPayloadBytes > 1 && mContext.mDataIdx % mPayloadBytes != 0)
+					AddPayloadFrame();
+				transmission_error = 1; noop = 1; mContext.mState = WAIT;
 				break;
 			}
-			case SOURCE:
-			{
-				starting_sample -= samples_per_bit / 2;
-				for (U32 i = 0; i < 12; i++)
-				{
-					//if 8 bits are sampled, skip the stop and start bit
-					if (bit_counter == 8) {
-						dd = dd << 4;
-						data_byte += dd;
-						ComputeCRC(data_byte);
-						if (!Rx_msg)	//when data in Tx, move Tx pointer
-						{
-							if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-								transmission_error = 1;
-                                mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                                mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-								break;
-							}
-							mTx->AdvanceToNextEdge();
-							mTx->Advance(samples_to_first_center_of_first_data_bit);
-						}
-						if (!mRx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-							transmission_error = 1;
-                            mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                            mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-							break;
-						}
-						mRx->AdvanceToNextEdge();
-						mRx->Advance(samples_to_first_center_of_first_data_bit);
-						bit_counter = 0;
-						data_byte = 0;
-						dd = 0;
-						first_byte = 0;
-					}
-					bit_counter++;
-					if (Rx_msg)		//msg in Rx
-					{
-						//if the time between the current moment and the last transition is more than timeout -> reset
-						if (!mRx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-							transmission_error = 1;
-                            mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                            mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-							break;
-						}
-						if (collision_detection)	//error X
-							mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mRxChannel);
-						//Source id computation - lsb first inversion
-						if (mRx->GetBitState() == BIT_HIGH) {
-							value = 1;
-							value_byte = 1;
-							for (U32 j = 0; j < i; j++) {
-								value *= 2;
-							}
-							if (!first_byte)
-							{
-								for (U32 j = 0; j < i - 4; j++)
-								{
-									value_byte *= 2;
-								}
-								dd += value_byte;
-							}
-							else {
-								dd += value;
-							}
-							data += value;
-						}
-						label = 'SRC';
-						mRx->Advance(samples_per_bit);
-					}
-					else
-					{
-						//if the time between the current moment and the last transition is more than timeout -> reset
-						if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-							transmission_error = 1;
-                            mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                            mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-							break;
-						}
-						mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mTxChannel);
-						mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::Square, mSettings->mRxChannel);
-						//Source id sent from Tx - lsb first inversion
-						if (mTx->GetBitState() == BIT_HIGH) {
-							value = 1;
-							value_byte = 1;
-							for (U32 j = 0; j < i; j++) {
-								value *= 2;
-							}
-							if (!first_byte)
-							{
-								for (U32 j = 0; j < i - 4; j++)
-								{
-									value_byte *= 2;
-								}
-								dd += value_byte;
-							}
-							else {
-								dd += value;
-							}
-							data += value;
-						}
-						if (mTx->GetBitState() == BIT_HIGH) {
-							value = 1;
-							value_byte = 1;
-							for (U32 j = 0; j < i; j++) {
-								value *= 2;
-							}
-							if (!first_byte)
-							{
-								for (U32 j = 0; j < i - 4; j++)
-								{
-									value_byte *= 2;
-								}
-								dd2 += value_byte;
-							}
-							else {
-								dd2 += value;
-							}
-							received_data += value;
-						}
-
-						if (!Rx_msg && received_data != data) {
-							collision_detection = 1;
-							Rx_msg = 1;
-							data = received_data;
-							dd = dd2;
-						}
-						label = 'SRC';
-						mTx->Advance(samples_per_bit);
-						mRx->Advance(samples_per_bit);
-					}
-				}
-				//reset
-				if (transmission_error) {
-					state = WAIT;
-					noop = 1;
-					break;
-				}
-				data_byte = dd;
-				ComputeCRC(data_byte);
-				data_byte = 0;
-				source = (uint16_t)data;
-				state = CMD;
-				break;
+			mContext.mMessage[mContext.mMessageSize++] = mContext.mDataByte;
+			data = mContext.mDataByte;
+			label = mContext.mDataIdx;
+			starting_sample = mContext.mByteStart + BitSamples(1);
+			ending_sample = mContext.mByteStart + BitSamples(9);
+			if (mContext.mDataIdx % mPayloadBytes == 0)
+				mContext.mPayloadStart = starting_sample;
+			mContext.mPayloadEnd = ending_sample;
+			mContext.mDataIdx++;
+			//if data number reach the size or the maximum data size -> terminate the reception
+			bool last_byte = (mContext.mDataIdx == mContext.mSize || mContext.mDataIdx == LUOS_MAX_DATA_SIZE);
+			//packed payload: a frame when it is full or at the last byte
+			if (mPayloadBytes > 1) {
+				noop = 1;
+				if (last_byte || mContext.mDataIdx % mPayloadBytes == 0)
+					AddPayloadFrame();
 			}
-			case CMD:
-			{
-				starting_sample += (uint64_t)samples_per_bit * 2 - samples_per_bit / 2;
-				if (!Rx_msg)		//when data in Tx , move Tx pointer
-				{
-
-					if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-						state = WAIT;
-                        mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                        mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						noop = 1;
-						transmission_error = 1;
-						break;
-					}
-					mTx->AdvanceToNextEdge();
-					mTx->Advance(samples_to_first_center_of_first_data_bit);
-				}
-
-
-				if (Rx_msg) {
-					if (!mRx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-						transmission_error = 1;
-                        mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                        mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						state = WAIT;
-						noop = 1;
-						break;
-					}
-				}
-				mRx->AdvanceToNextEdge();
-				mRx->Advance(samples_to_first_center_of_first_data_bit);
-				bit_counter = 0;
-				for (U32 i = 0; i < 8; i++)
-				{
-					//let's put a dot exactly where we sample this bit:
-					bit_counter++;
-					if (Rx_msg)
-					{
-						//if the time between the current moment and the last transition is more than timeout -> reset
-						if (!mRx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-							transmission_error = 1;
-                            mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                            mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-							break;
-						}
-						if (collision_detection) //error X
-							mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mRxChannel);
-						//cmd computation - lsb first inversion
-						if (mRx->GetBitState() == BIT_HIGH) {
-							value = 1;
-							for (U32 j = 0; j < i; j++) {
-								value *= 2;
-							}
-							data += value;
-							data_byte += (uint8_t)value;
-						}
-						label = 'CMD';
-						mRx->Advance(samples_per_bit);
-					}
-					else
-					{
-						//if the time between the current moment and the last transition is more than timeout -> reset
-						if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-							transmission_error = 1;
-                            mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                            mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-							break;
-						}
-						mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mTxChannel);
-
-						if (mTx->GetBitState() == BIT_HIGH) {
-							value = 1;
-							for (U32 j = 0; j < i; j++) {
-								value *= 2;
-							}
-							data += value;
-							data_byte += (uint8_t)value;
-						}
-						label = 'CMD';
-						mTx->Advance(samples_per_bit);
-						mRx->Advance(samples_per_bit);
-					}
-				}
-				if (mRx->GetSampleNumber() > mTx->GetSampleNumber())
-					mTx->AdvanceToAbsPosition(mRx->GetSampleNumber());
-				if (transmission_error) {
-					state = WAIT;
-					noop = 1;
-					break;
-				}
-				state = SIZE;
-				first_byte = 1;
-				ComputeCRC(data_byte);
-				data_byte = 0;
-				break;
+			if (last_byte) {
+				mContext.mState = CRC;
+				mContext.mDataIdx = 0;
 			}
-			case SIZE:
-			{
-				starting_sample += (uint64_t)samples_per_bit * 2 - samples_per_bit / 2;
-				if (Rx_msg)
-				{
-					if (!mRx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-						transmission_error = 1;
-                        mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                        mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						state = WAIT;
-						noop = 1;
-						break;
-					}
-					mRx->AdvanceToNextEdge();
-					mRx->Advance(samples_to_first_center_of_first_data_bit);
-				}
-				else
-				{
-					if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-						transmission_error = 1;
-                        mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                        mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						state = WAIT;
-						noop = 1;
-						break;
-					}
-					mTx->AdvanceToNextEdge();
-					mTx->Advance(samples_to_first_center_of_first_data_bit);
-				}
-				bit_counter = 0;
-				for (U32 i = 0; i < 16; i++)
-				{
-					//if 8 bits are sampled, skip the stop and start bit
-					if (bit_counter == 8) {
-						ComputeCRC(data_byte);
-						if (Rx_msg)				//if msg in Rx, move Rx pointer
-						{
-							mRx->AdvanceToNextEdge();
-							mRx->Advance(samples_to_first_center_of_first_data_bit);
-						}
-						else {						//if msg in Tx, move Tx pointer
-							mTx->AdvanceToNextEdge();
-							mTx->Advance(samples_to_first_center_of_first_data_bit);
-						}
-						bit_counter = 0;
-						data_byte = 0;
-						first_byte = 0;
-					}
-
-					if (Rx_msg) {				//msg in Rx
-						//if the time between the current moment and the last transition is more than timeout -> reset
-						if (!mRx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-							transmission_error = 1;
-                            mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                            mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-							break;
-						}
-						if (collision_detection)
-							mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mRxChannel);
-						bit_counter++;
-						//Size - lsb first inversion
-						if (mRx->GetBitState() == BIT_HIGH) {
-							value = 1;
-							value_byte = 1;
-							for (U32 j = 0; j < i; j++) {
-								value *= 2;
-							}
-							if (!first_byte) {
-								for (U32 j = 0; j < i - 8; j++) {
-
-									value_byte *= 2;
-								}
-								data_byte += (uint8_t)value_byte;
-							}
-							else {
-								data_byte += (uint8_t)value;
-							}
-							data += value;
-						}
-						label = 'SIZE';
-						mRx->Advance(samples_per_bit);
-					}
-					else {
-						//if the time between the current moment and the last transition is more than timeout -> reset
-						if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-							transmission_error = 1;
-                            mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                            mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-                            break;
-						}
-						mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mTxChannel);
-						bit_counter++;
-						//Size - lsb first inversion
-						if (mTx->GetBitState() == BIT_HIGH) {
-							value = 1;
-							value_byte = 1;
-							for (U32 j = 0; j < i; j++) {
-								value *= 2;
-							}
-							if (!first_byte) {
-								for (U32 j = 0; j < i - 8; j++) {
-
-									value_byte *= 2;
-								}
-								data_byte += (uint8_t)value_byte;
-							}
-							else {
-								data_byte += (uint8_t)value;
-							}
-							data += value;
-						}
-						label = 'SIZE';
-						mTx->Advance(samples_per_bit);
-					}
-				}
-				if (mRx->GetSampleNumber() > mTx->GetSampleNumber())
-					mTx->AdvanceToAbsPosition(mRx->GetSampleNumber());
-				if (transmission_error) {
-					state = WAIT;
-					noop = 1;
-					break;
-				}
-				size = data;
-				ComputeCRC(data_byte);
-				if (size == 0) { state = CRC; }
-				else { state = DATA; }
-				data_byte = 0;
+			break;
+		}
+		case CRC:
+		{
+			if (!ChannelPolicy::ReadByte(*this, mContext.mFieldStart, mContext.mFirstByte) ||
+				!ChannelPolicy::ReadByte(*this, mContext.mByteStart, mContext.mDataByte)) {
+				transmission_error = 1; noop = 1; mContext.mState = WAIT;
 				break;
 			}
-			case DATA:
-			{
-				starting_sample += (uint64_t)samples_per_bit * 2 - samples_per_bit / 2;
-				if (Rx_msg)
-				{
-					if (!mRx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-						transmission_error = 1;
-                        mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                        mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						state = WAIT;
-						noop = 1;
-						break;
-					}
-					mRx->AdvanceToNextEdge();
-					mRx->Advance(samples_to_first_center_of_first_data_bit);
-
-					for (U32 i = 0; i < 8; i++)
-					{
-						//if the time between the current moment and the last transition is more than timeout -> reset
-						if (!mRx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-							transmission_error = 1;
-                            mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                            mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-							break;
-						}
-						if (collision_detection) //error X
-							mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mRxChannel);
-						//Data - lsb first inversion
-						if (mRx->GetBitState() == BIT_HIGH)
-						{
-							value = 1;
-
-							for (U32 j = 0; j < i; j++)
-							{
-								value *= 2;
-							}
-
-							data += value;
-							data_byte += (uint8_t)value;
-						}
-						label = data_idx;
-						mRx->Advance(samples_per_bit);
-					}
-				}
-				else {
-					if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-						transmission_error = 1;
-                        mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                        mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						state = WAIT;
-						noop = 1;
-						break;
-					}
-					mTx->AdvanceToNextEdge();
-					mTx->Advance(samples_to_first_center_of_first_data_bit);
-
-
-					for (U32 i = 0; i < 8; i++)
-					{
-						//if the time between the current moment and the last transition is more than timeout -> reset
-						if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-							transmission_error = 1;
-                            mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                            mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-							break;
-						}
-						mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mTxChannel);
-						//Data - lsb first inversion
-						if (mTx->GetBitState() == BIT_HIGH)
-						{
-							value = 1;
-							for (U32 j = 0; j < i; j++)
-							{
-								value *= 2;
-							}
-							data += value;
-							data_byte += (uint8_t)value;
-						}
-						label = data_idx;
-						mTx->Advance(samples_per_bit);
-					}
-				}
-				//reset
-				if (mRx->GetSampleNumber() > mTx->GetSampleNumber())
-					mTx->AdvanceToAbsPosition(mRx->GetSampleNumber());
-				if (transmission_error) {
-					state = WAIT;
-					noop = 1;
-					data_idx = 0;
-					break;
-				}
-				ComputeCRC(data_byte);
-				data_idx++;
-				data_byte = 0;
-				//if data number reach the size or the maximum data size -> terminate the reception
-				if (data_idx == size || data_idx == 128) {
-					state = CRC;
-					data_idx = 0;
-				}
+			data = mContext.mFirstByte | ((U64)mContext.mDataByte << 8);
+			starting_sample = mContext.mFieldStart + BitSamples(1);
+			ending_sample = mContext.mByteStart + BitSamples(9);
+			mContext.mCrc.Reset();
+			mContext.mCrc.Update(mContext.mMessage, mContext.mMessageSize);
+
+			//Last bit of CRC - Timeout timer is on!
+			mContext.mTracking = mContext.mByteStart + SamplePoint(8);
+			if (data != mContext.mCrc.GetCrc() && mErrorMarkers)
+				mResults->AddMarker(mContext.mTracking, AnalyzerResults::ErrorX, ChannelPolicy::MessageChannel(*this));
+			mContext.mTracking = mContext.mByteStart + BitSamples(9);
+			if (mTimeoutMarkers)
+				ChannelPolicy::AddMarker(*this, mContext.mTracking, AnalyzerResults::Start);		//green symbol for timeout start
+			mContext.mTracking += mTimeout;
+			ChannelPolicy::EndOfMessage(*this);
+			mContext.mInfo.mEndSample = ending_sample;
+			mContext.mInfo.mCrc = U16(data);
+			mContext.mInfo.mCrcGood = (data == mContext.mCrc.GetCrc());
+
+			//crc sent compared to crc computed - if not equal, data corrupted
+			if (data != mContext.mCrc.GetCrc()) {
+				label = 'NOT';
+				transmission_error = 1;
+				mContext.mState = WAIT;
 				break;
 			}
-			case CRC:
-			{
-				starting_sample += (uint64_t)samples_per_bit * 2 - samples_per_bit / 2;
-				if (Rx_msg)	//msg in Rx
-				{
-					if (!mRx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-						transmission_error = 1;
-                        mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                        mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						state = WAIT;
-						noop = 1;
-						break;
-					}
-					mRx->AdvanceToNextEdge();
-					mRx->Advance(samples_to_first_center_of_first_data_bit);
-
-					bit_counter = 0;
-					for (U32 i = 0; i < 16; i++)
-					{
-						if ((!mRx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) && i <= 8) {
-							ack = 0;
-                            mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                            mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-							transmission_error = 1;
-							break;
-						}
-						if (bit_counter == 8)  //if 8 bits sampled, skip Start and Stop bit
-						{
-							mRx->AdvanceToNextEdge();
-							mRx->Advance(samples_to_first_center_of_first_data_bit);
-							bit_counter = 0;
-						}
-						//crc reception
-						if (mRx->GetBitState() == BIT_HIGH)
-						{
-							value = 1;
-							for (U32 j = 0; j < i; j++) {
-
-								value *= 2;
-							}
-							data += value;
-						}
-						if ((i == 15))
-						{
-							if (collision_detection)		//errorX
-								mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-							//Last bit of CRC - Timeout timer is on!
-                            if (data!=crc_val)
-                                mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                            else
-                                mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mRxChannel);
-							tracking = mRx->GetSampleNumber() + samples_per_bit / 2;
-							mResults->AddMarker(tracking, AnalyzerResults::Start, mSettings->mTxChannel);
-							mResults->AddMarker(tracking, AnalyzerResults::Start, mSettings->mRxChannel);
-							if (mRx->GetSampleNumber() > mTx->GetSampleNumber())
-								mTx->AdvanceToAbsPosition(mRx->GetSampleNumber());
-							tracking += timeout * samples_per_bit;
-                            if (ack) {
-                                if (mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit) || mRx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-                                    state = ACK;
-                                }
-                                else {
-                                    mResults->AddMarker(tracking, AnalyzerResults::ErrorX, mSettings->mTxChannel);
-                                    mResults->AddMarker(tracking, AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                                    state = WAIT;
-                                }
-                            }
-                            else {
-                                mResults->AddMarker(tracking, AnalyzerResults::Start, mSettings->mTxChannel);
-                                mResults->AddMarker(tracking, AnalyzerResults::Start, mSettings->mRxChannel);
-                            }
-                        }
-						else {
-							if (collision_detection)		//errorX
-								mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-							mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mRxChannel);
-						}
-						bit_counter++;
-						mRx->Advance(samples_per_bit);
-					}
-				}
-				else {	//msg in Tx
-					if (!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-						transmission_error = 1;
-                        mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                        mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-						state = WAIT;
-						noop = 1;
-					}
-					mTx->AdvanceToNextEdge();
-					mTx->Advance(samples_to_first_center_of_first_data_bit);
-					
-
-					bit_counter = 0;
-					for (U32 i = 0; i < 16; i++)
-					{
-
-						if ((!mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) && i <= 8) {		//if no data for timeout period - error
-                            mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                            mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-							transmission_error = 1;
-							break;
-						}
-						if (bit_counter == 8)  //if 8 bits sampled, skip Start and Stop bit
-						{
-							mTx->AdvanceToNextEdge();
-							mTx->Advance(samples_to_first_center_of_first_data_bit);
-							bit_counter = 0;
-						}
-						//crc reception
-						if (mTx->GetBitState() == BIT_HIGH)
-						{
-							value = 1;
-							for (U32 j = 0; j < i; j++) {
-
-								value *= 2;
-							}
-							data += value;
-						}
-						if (i == 15)
-						{
-							//Last bit of CRC - Timeout timer is on!
-                            if (crc_val!=data) {
-                                mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-                                mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mTxChannel);
-                            }
-                            else
-                                mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mTxChannel);
-							tracking = mTx->GetSampleNumber() + samples_per_bit / 2;
-							if (mTx->GetSampleNumber() > mRx->GetSampleNumber())    //Rx pointer is left behind
-								mRx->AdvanceToAbsPosition(mTx->GetSampleNumber());
-							mResults->AddMarker(tracking, AnalyzerResults::Start, mSettings->mTxChannel);			//green symbol for timeout start
-							mResults->AddMarker(tracking, AnalyzerResults::Start, mSettings->mRxChannel);			//green symbol for timeout beginning
-							tracking += timeout * samples_per_bit;
-                            if (ack)
-                            {
-                                if (mRx->WouldAdvancingCauseTransition(timeout * samples_per_bit) || mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-                                    state = ACK;    //if there is data in less than timeout -> ack found
-                                }
-                                else {
-                                    mResults->AddMarker(tracking, AnalyzerResults::ErrorX, mSettings->mTxChannel);
-                                    mResults->AddMarker(tracking, AnalyzerResults::ErrorX, mSettings->mRxChannel);
-                                    state = WAIT;
-                                }
-                            }
-                            else {
-                                mResults->AddMarker(tracking, AnalyzerResults::Start, mSettings->mTxChannel);
-                                mResults->AddMarker(tracking, AnalyzerResults::Start, mSettings->mRxChannel);
-                            }
-						}
-						else
-							mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mTxChannel);
-
-						bit_counter++;
-						mTx->Advance(samples_per_bit);
-					}
-				}
-				if (mRx->GetSampleNumber() > mTx->GetSampleNumber())
-					mTx->AdvanceToAbsPosition(mRx->GetSampleNumber());			//Tx reach the position of Rx
-				if (transmission_error) {
-					state = WAIT;
-					noop = 1;
-					break;
-				}
-				//crc evaluation
-				if (data == crc_val)
-					label = 'CRC';
-				else {
-					label = 'NOT';
-					transmission_error = 1;
-				}
-				if (ack == 0)
-					state = WAIT;
-
-				bit_counter = 0;
-				break;
+			label = 'CRC';
+			if (!mContext.mAck) {
+				if (mTimeoutMarkers)
+					ChannelPolicy::AddMarker(*this, mContext.mTracking, AnalyzerResults::Start);
+				mContext.mState = WAIT;
 			}
-			case ACK:
-			{
-				if (target == source)				//ack to the same channel with the msg
-				{
-					mTx->AdvanceToNextEdge();
-					mTx->Advance(samples_to_first_center_of_first_data_bit);
-					starting_sample = mTx->GetSampleNumber() - (samples_per_bit / 2);   //find the position of ack frame
-
-					for (U32 i = 0; i < 8; i++)     //sample the 8 ack bits
-					{
-						mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mTxChannel);
-						if (mTx->GetBitState() == BIT_HIGH) {
-							value = 1;
-							for (U32 j = 0; j < i; j++)
-								value *= 2;
-
-							data += value;
-						}
-						label = 'ACK';
-						mTx->Advance(samples_per_bit);
-					}
-				}
-				else			//ack to the other channel => if msg in Rx -> ack to Tx / if msg in Tx -> ack to Rx
-				{
-					if (Rx_msg)
-					{
-						if (target == 0) {		//if target = 0 and message to Rx -> ack to Rx
-							mRx->AdvanceToNextEdge();
-							mRx->Advance(samples_to_first_center_of_first_data_bit);
-							starting_sample = mRx->GetSampleNumber() - (samples_per_bit / 2);
-							for (U32 i = 0; i < 8; i++)
-							{
-								mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mRxChannel);
-								if (mRx->GetBitState() == BIT_HIGH) {		//ack value - lsb inversion
-									value = 1;
-									for (U32 j = 0; j < i; j++)
-										value *= 2;
-
-									data += value;
-								}
-								label = 'ACK';
-
-								mRx->Advance(samples_per_bit);
-							}
-						}
-						else {		//ack to Tx channel
-							mTx->AdvanceToNextEdge();
-							mTx->Advance(samples_per_bit / 2);
-							starting_sample = mTx->GetSampleNumber() - (samples_per_bit / 2);
-							for (U32 i = 0; i < 8; i++)
-							{
-								mResults->AddMarker(mTx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mTxChannel);
-
-								if (mTx->GetBitState() == BIT_HIGH) {
-									value = 1;
-									for (U32 j = 0; j < i; j++)
-										value *= 2;
-
-									data += value;
-								}
-								label = 'ACK';
-
-								mTx->Advance(samples_per_bit);
-							}
-							if (mTx->GetSampleNumber() > mRx->GetSampleNumber())
-								mRx->AdvanceToAbsPosition(mTx->GetSampleNumber());
-							mTx->AdvanceToNextEdge();
-						}
-					}
-					else	//ack to Rx channel
-					{
-						mRx->AdvanceToAbsPosition(mTx->GetSampleNumber());
-						mRx->AdvanceToNextEdge();
-						mRx->Advance(samples_to_first_center_of_first_data_bit);	//find ack position
-						starting_sample = mRx->GetSampleNumber() - (samples_per_bit / 2);
-						for (U32 i = 0; i < 8; i++)
-						{
-
-							mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::Dot, mSettings->mRxChannel);
-
-							bit_counter++;
-							if (mRx->GetBitState() == BIT_HIGH) {		//ack value
-								value = 1;
-								for (U32 j = 0; j < i; j++)
-									value *= 2;
-
-								data += value;
-							}
-							label = 'ACK';
-
-							mRx->Advance(samples_per_bit);
-						}
-						if (mRx->GetSampleNumber() > mTx->GetSampleNumber())
-							mTx->AdvanceToAbsPosition(mRx->GetSampleNumber());			//Tx reach the position of Rx
-					}
-				}
-				
-				if (!Rx_msg && mRx->GetSampleNumber() < mTx->GetSampleNumber())
-					mRx->AdvanceToAbsPosition(mTx->GetSampleNumber());
-
-				mResults->AddMarker(tracking, AnalyzerResults::Stop, mSettings->mTxChannel);
-				mResults->AddMarker(tracking, AnalyzerResults::Stop, mSettings->mRxChannel);
-                tracking = mRx->GetSampleNumber();
-                tracking += timeout*samples_per_bit - samples_per_bit/2;
-                mResults->AddMarker(tracking, AnalyzerResults::Start, mSettings->mTxChannel);
-                mResults->AddMarker(tracking, AnalyzerResults::Start, mSettings->mRxChannel);
-				state = WAIT;
-				ack = 0;
-				bit_counter = 0;
-				break;
+			else if (ChannelPolicy::AckStarts(*this))
+				mContext.mState = ACK;    //if there is data in less than timeout -> ack found
+			else {
+				if (mErrorMarkers)
+					ChannelPolicy::AddMarker(*this, mContext.mTracking, AnalyzerResults::ErrorX);
+				mContext.mState = WAIT;
 			}
-			default:
-			{
-				state = WAIT;
+			break;
+		}
+		case ACK:
+		{
+			//we enter this case only if we find an ack before timeout
+			mContext.mAck = 0;
+			if (!ChannelPolicy::ReadAck(*this, mContext.mByteStart, mContext.mDataByte)) {
+				transmission_error = 1; noop = 1; mContext.mState = WAIT;
 				break;
 			}
-			}
+			data = mContext.mDataByte;
+			label = 'ACK';
+			starting_sample = mContext.mByteStart + BitSamples(1);
+			ending_sample = mContext.mByteStart + BitSamples(9);
+			mContext.mInfo.mAcked = true;
+			mContext.mInfo.mAck = mContext.mDataByte;
+			mContext.mInfo.mAckSample = starting_sample;
+			//end of the ack timeout and beginning of the next one
+			if (mTimeoutMarkers)
+				ChannelPolicy::AddMarker(*this, mContext.mTracking, AnalyzerResults::Stop);
+			mContext.mTracking = ending_sample + mTimeout;
+			if (mTimeoutMarkers)
+				ChannelPolicy::AddMarker(*this, mContext.mTracking, AnalyzerResults::Start);
+			mContext.mState = WAIT;
+			break;
+		}
+		default:
+		{
+			noop = 1;
+			mContext.mState = WAIT;
+			break;
+		}
+		}
 
-			if (collision_detection && Rx_msg && state == WAIT) {			//end of message
-				ack = 0;
+		//send a frame only if there is not a transmission_error
+		if (!noop)
+			AddFieldFrame(label, data, starting_sample, ending_sample);
+		//wait state is used when we look for a new message: no data, transmission_error, ack wait, end of msg, etc
+		if (mContext.mState == WAIT)
+		{
+			//end of the msg - one packet per msg, a msg cut by a reading error is not kept as a packet
+			if ((transmission_error && noop) || mContext.mMessageSize == 0)
+				mResults->CancelPacketAndStartNewPacket();
+			else {
+				//stored first: a packet shown has its bytes
+				mContext.mInfo.mStartSample = mContext.mHeaderStart[0] + BitSamples(1);
+				U64 message_id = mMessages.AddMessage(mContext.mMessage, mContext.mMessageSize, mContext.mInfo);
+				U64 packet_id = mResults->CommitPacketAndStartNewPacket();
+				//the results read the msg of a packet by its packet id: a cancelled packet does not take an id
+				assert(packet_id == message_id);
+				AddToTransaction(packet_id);
 			}
-			if (!noop) {			//if noop=1 ->send no frame
-				Frame frame;
-				frame.mData1 = label;
-				frame.mData2 = data;
-				frame.mFlags = 0;
-				frame.mStartingSampleInclusive = starting_sample;
-
-				if (Rx_msg)
-					frame.mEndingSampleInclusive = mRx->GetSampleNumber() - samples_per_bit / 2;
-				else
-					frame.mEndingSampleInclusive = mTx->GetSampleNumber() - samples_per_bit / 2;
-
-				mResults->AddFrame(frame);
-				mResults->CommitResults();
-				ReportProgress(frame.mEndingSampleInclusive);
+			//show it before waiting for the next one
+			CommitFrames();
+			ChannelPolicy::WaitForMessage(*this, transmission_error);
+			mContext.StartMessage();
+			mContext.mState = HEADER;
+		}
+	}
+}
+
+void LuosAnalyzer::AddFieldFrame(U64 label, U64 data, U64 starting_sample, U64 ending_sample, U8 type, U8 flags)
+{
+	Frame frame;
+	frame.mData1 = label;
+	frame.mData2 = data;
+	frame.mType = type;
+	frame.mFlags = flags;
+	//glitches were filtered while this field was received
+	if (mGlitchCount != mFrameGlitchCount) {
+		frame.mFlags |= DISPLAY_AS_WARNING_FLAG;
+		mFrameGlitchCount = mGlitchCount;
+	}
+	frame.mStartingSampleInclusive = starting_sample;
+	frame.mEndingSampleInclusive = ending_sample;
+
+	mResults->AddFrame(frame);
+	mLastFrameSample = ending_sample;
+
+	//a msg lasting more than an update period is shown without waiting for its end
+	if (mPendingFrames++ == 0)
+		mPendingStart = starting_sample;
+	else if (ending_sample - mPendingStart >= mUpdatePeriod)
+		CommitFrames();
+}
+
+//Function to add a frame for each header field completed by the bytes [first_byte, end_byte) - positions come from the field bits
+void LuosAnalyzer::AddHeaderFrames(U32 first_byte, U32 end_byte)
+{
+	for (U32 i = 0; i < HEADER_FIELDS; i++)
+	{
+		const LuosHeaderField& field = LUOS_HEADER_LAYOUT[i];
+		if (field.LastByte() < first_byte || field.LastByte() >= end_byte)
+			continue;
+		AddFieldFrame(field.mLabel, field.Extract(mContext.mHeader),
+			mContext.mHeaderStart[field.FirstByte()] + BitSamples(1 + field.FirstBit()),     //skip the start bit
+			mContext.mHeaderStart[field.LastByte()] + BitSamples(1 + field.EndBit()));
+	}
+}
+
+//Function to add a frame for the payload bytes received since the last one - mData1 then mData2, first byte in the low byte
+void LuosAnalyzer::AddPayloadFrame()
+{
+	U32 first = (mContext.mDataIdx - 1) / mPayloadBytes * mPayloadBytes;
+	U32 count = mContext.mDataIdx - first;
+	const U8* bytes = &mContext.mMessage[LUOS_HEADER_SIZE + first];
+	U64 data[2] = { 0, 0 };
+
+	for (U32 i = 0; i < count; i++)
+		data[i / 8] |= (U64)bytes[i] << (8 * (i % 8));
+	AddFieldFrame(data[0], data[1], mContext.mPayloadStart, mContext.mPayloadEnd, U8(PAYLOAD_FRAME | ((first / 8) << 4)), U8(count - 1));
+}
+
+/*Function to group the packets of a request and its response. An IDACK/NODEIDACK msg holds its ack, an ASK_PUB_CMD msg
+sent to a node waits for the next msg of this node until the response timeout. The transaction id is the packet id of the request, the pending
+requests are found in O(1) by node id*/
+void LuosAnalyzer::AddToTransaction(U64 packet_id)
+{
+	U64 mode = LUOS_HEADER_LAYOUT[HEADER_MODE].Extract(mContext.mHeader);
+	U64 cmd = LUOS_HEADER_LAYOUT[HEADER_CMD].Extract(mContext.mHeader);
+	U64 transaction_id = packet_id;
+	LuosTransfer& transfer = mContext.mTransfers[mContext.mSource];
+
+	//next fragment of the transfer of this source: it joins the transaction of the first one
+	if (transfer.mSize != 0) {
+		if (transfer.mTarget == mContext.mTarget && transfer.mCmd == cmd && mContext.mSize == transfer.mSize - transfer.mSent) {
+			mResults->AddPacketToTransaction(transfer.mTransaction, packet_id);
+			AddFragment(transfer);
+			return;
+		}
+		//a fragment is missing - the transfer is stored incomplete as it is
+		transfer.mSize = 0;
+	}
+
+	//a request the source has not answered within the response timeout is closed without response
+	U64& request = mContext.mRequest[mContext.mSource];
+	if (request != 0 && mContext.mInfo.mStartSample > mContext.mRequestEnd[mContext.mSource] + mResponseTimeout)
+		request = 0;
+	bool response = (request != 0);
+
+	if (response) {
+		transaction_id = request - 1;
+		request = 0;
+	}
+	bool node_target = (mode == MODE_ID || mode == MODE_IDACK || mode == MODE_NODEID || mode == MODE_NODEIDACK);
+	bool ask_pub = (cmd == LUOS_ASK_PUB_CMD && node_target);
+	if (response || ask_pub || mode == MODE_IDACK || mode == MODE_NODEIDACK || mContext.mSize > LUOS_MAX_DATA_SIZE)
+		mResults->AddPacketToTransaction(transaction_id, packet_id);
+	//a response can ask for the next one: the whole exchange is one transaction
+	//a new request to a node closes the one it has not answered
+	if (ask_pub) {
+		mContext.mRequest[mContext.mTarget] = transaction_id + 1;
+		mContext.mRequestEnd[mContext.mTarget] = mContext.mInfo.mEndSample;
+	}
+
+	//first fragment of a transfer
+	if (mContext.mSize > LUOS_MAX_DATA_SIZE) {
+		transfer.mTransaction = transaction_id;
+		transfer.mFirstPacket = packet_id;
+		transfer.mSource = mContext.mSource;
+		transfer.mTarget = mContext.mTarget;
+		transfer.mCmd = U8(cmd);
+		transfer.mSize = mContext.mSize;
+		transfer.mSent = 0;
+		transfer.mReceived = 0;
+		transfer.mFragments = 0;
+		transfer.mComplete = false;
+		transfer.mStartSample = mContext.mHeaderStart[0];
+		mContext.mTransferIds[mContext.mSource] = mMessages.AddTransfer(transfer);
+		AddFragment(transfer);
+	}
+}
+
+//Function to add the msg just received to a transfer and update it in the store - the bytes of a fragment with a bad crc are not received,
+//the transfer ends with the fragment sending its last bytes
+void LuosAnalyzer::AddFragment(LuosTransfer& transfer)
+{
+	U32 payload = mContext.mMessageSize - LUOS_HEADER_SIZE;
+	transfer.mSent += payload;
+	if (mContext.mInfo.mCrcGood)
+		transfer.mReceived += payload;
+	transfer.mFragments++;
+	transfer.mEndSample = mLastFrameSample;
+	transfer.mComplete = (transfer.mReceived == transfer.mSize);
+	mMessages.SetTransfer(mContext.mTransferIds[transfer.mSource], transfer);
+	if (transfer.mSent == transfer.mSize)
+		transfer.mSize = 0;
+}
+
+void LuosAnalyzer::CommitFrames()
+{
+	if (mPendingFrames == 0)
+		return;
+	mResults->CommitResults();
+	mPendingFrames = 0;
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (now >= mNextProgress) {
+		ReportProgress(mLastFrameSample);
+		mNextProgress = now + mProgressPeriod;
+	}
+}
+
+/*Function to decode one character - the channel is on the falling edge of its start bit.
+Only the edges of the character are visited: a sample point before the next edge has the current level.
+With the majority vote a bit is the level of 2 of the 3 samples around its sample point. The edges of a pulse shorter than the glitch filter are skipped.
+The channel is left on the last sample of the stop bit. Returns false if the stop bit is not high (framing error)*/
+bool LuosAnalyzer::ReadByte(AnalyzerChannelData* channel_data, Channel& channel, AnalyzerResults::MarkerType marker, U8& byte)
+{
+	U64 start = channel_data->GetSampleNumber();
+	U64 bit_offset = mBitPeriod + mSampleOffset;      //fixed point offset of the sample point of the first data bit
+	U64 stop_bit_center = start + SamplePoint(9);
+	U64 last_sample = stop_bit_center + mVoteOffset;
+	BitState bit_state = BIT_LOW;       //start bit
+	U64 next_edge = NextEdge(channel_data, bit_state, last_sample);
+	bool bit_high = false;
+
+	byte = 0;
+	if (mByteMarkers)
+		mResults->AddMarker(start, AnalyzerResults::Start, channel);
+	for (U32 bit = 0; bit < 9; bit++)       //8 data bits, then the stop bit
+	{
+		U64 bit_center = start + (bit_offset >> LUOS_BIT_FRACTION);
+		U64 sample = bit_center - mVoteOffset * (mVotes / 2);
+		U32 high_samples = 0;
+		bit_offset += mBitPeriod;
+		for (U32 vote = 0; vote < mVotes; vote++, sample += mVoteOffset)
+		{
+			while (next_edge <= sample) {
+				channel_data->AdvanceToNextEdge();
+				if (!SkipGlitch(channel_data, channel))
+					bit_state = Toggle(bit_state);
+				next_edge = NextEdge(channel_data, bit_state, last_sample);
 			}
-			/*This state is the default state. It is enabled in case of no data, transmission_error, ack wait, end of msg, etc
-			and it waits until the next msg|*/
-			if (state == WAIT)
-			{
-				while (1)
-				{
-					CheckIfThreadShouldExit();
-					if (transmission_error)			//This is the handling of a transmission_error in case CRC is not good! Wait until we find a no data timeout period
-					{
-						if (Rx_msg)
-						{
-							if ((mRx->GetSampleNumber() > mTx->GetSampleNumber()) && (mRx->GetSampleNumber() - mTx->GetSampleNumber() > timeout * samples_per_bit))
-								mTx->AdvanceToNextEdge();
-							if (!mRx->WouldAdvancingCauseTransition(timeout * samples_per_bit)) {
-								
-								mRx->AdvanceToNextEdge();
-								if ((mRx->GetSampleNumber() > mTx->GetSampleNumber()) && (mRx->GetSampleNumber() - mTx->GetSampleNumber() > timeout * samples_per_bit)) {
-									while (mTx->WouldAdvancingCauseTransition(timeout * samples_per_bit))
-										mTx->AdvanceToNextEdge();
-									mTx->AdvanceToNextEdge();
-								}
-									
-								if (mRx->GetSampleNumber() < mTx->GetSampleNumber()) {			//if we found a msg in Rx earlier Rx_msg
-									if (mTx->GetSampleNumber() - mRx->GetSampleNumber() < timeout * samples_per_bit)	//if we also have a Tx msg close to Rx ->collision
-										collision_detection = 1;
-									else collision_detection = 0;
-										Rx_msg = 1;
-								}
-								else
-									Rx_msg = 0;
-								state = PROTOCOL;			//Restart
-								
-								//if (!noop)
-								mRx->Advance(samples_to_first_center_of_first_data_bit);
-								bit_counter = 0;
-								ack = 0;
-								break;
-							}
-							else {
-								state = WAIT;
-								mRx->AdvanceToNextEdge();
-								continue;
-							}
-						}
-						else			//same for Tx msg
-						{
-							if (mRx->GetSampleNumber() < mTx->GetSampleNumber())
-								mRx->AdvanceToNextEdge();
-							if (!mTx->WouldAdvancingCauseTransition(timeout*samples_per_bit)) {
-								mTx->AdvanceToNextEdge();
-					
-								if (mRx->GetSampleNumber() < mTx->GetSampleNumber()) {
-									if (mTx->GetSampleNumber() - mRx->GetSampleNumber() < timeout * samples_per_bit)
-										collision_detection = 1;
-									else collision_detection = 0;
-									Rx_msg = 1;
-								}
-								else {
-									Rx_msg = 0;
-								}
-								state = PROTOCOL;
-								//if (!noop)
-								mRx->Advance(samples_to_first_center_of_first_data_bit);
-								
-								bit_counter = 0;
-								ack = 0;
-								break;
-							}
-							else {
-								state = WAIT;
-								mTx->AdvanceToNextEdge();
-								continue;
-							}
-						}
-					}
-					//Initialization of the next message - Reset state machine
-					if (!Rx_msg) {
-						if (mRx->GetSampleNumber() < mTx->GetSampleNumber() && mTx->GetSampleNumber() - mRx->GetSampleNumber() > timeout * samples_per_bit)
-							mRx->AdvanceToAbsPosition(mTx->GetSampleNumber());
-						mTx->AdvanceToNextEdge();
-						
-					}
-					if (!noop && !collision_detection) {				//Normally, in Tx msg Rx is left behind, so we advance to the next msg
-						mRx->AdvanceToNextEdge();
-					}
-					if (mTx->GetSampleNumber() > mRx->GetSampleNumber())		//data found in Rx? ->Rx msg
-					{
-						if (mTx->GetSampleNumber() - mRx->GetSampleNumber() < timeout * samples_per_bit)		//Data found in Tx also -> collision
-							collision_detection = 1;
-						else collision_detection = 0;
-
-						Rx_msg = 1;
-						starting_sample += samples_per_bit;
-						if (mRx->GetBitState() == BIT_LOW)		//reset
-						{
-							mRx->Advance(samples_to_first_center_of_first_data_bit);
-							state = PROTOCOL;
-							break;
-						}
-					}
-					else {
-						if (mRx->GetSampleNumber() - mTx->GetSampleNumber() > timeout * samples_per_bit) {		//In case of a previous error if we still have data we wait
-							Rx_msg = 0;
-							transmission_error = 1;
-							continue;
-						}
-						//We finally can go to the next msg
-						collision_detection = 0;
-						Rx_msg = 0;
-						starting_sample += samples_per_bit;
-						if (mTx->GetBitState() == BIT_LOW)
-						{
-							mRx->Advance(samples_to_first_center_of_first_data_bit);
-							state = PROTOCOL;
-							break;
-						}
-					}
-				}
+			if (bit_state == BIT_HIGH)
+				high_samples++;
+		}
+		bit_high = (2 * high_samples > mVotes);
+		if (bit == 8)
+			break;
+
+		//let's put a marker exactly where we sample this bit:
+		if (mBitMarkers)
+			mResults->AddMarker(bit_center, marker, channel);
+		if (bit_high)
+			byte |= 1 << bit;   //lsb first
+	}
+	//only a skipped glitch can end after the last sample
+	if (mGlitchWidth < 2 || channel_data->GetSampleNumber() < last_sample)
+		channel_data->AdvanceToAbsPosition(last_sample);
+	if (mByteMarkers)
+		mResults->AddMarker(stop_bit_center, AnalyzerResults::Stop, channel);
+	return bit_high;
+}
+
+//Function to get the sample of the next edge - a low line always rises again, a high one may stay idle until the next msg: limit + 1 if no edge until limit
+U64 LuosAnalyzer::NextEdge(AnalyzerChannelData* channel_data, BitState bit_state, U64 limit)
+{
+	if (bit_state == BIT_LOW || channel_data->WouldAdvancingToAbsPositionCauseTransition(limit))
+		return channel_data->GetSampleOfNextEdge();
+	return limit + 1;
+}
+
+//Function to skip a pulse shorter than the glitch filter - the channel is on its first edge and is left on the second one
+bool LuosAnalyzer::SkipGlitch(AnalyzerChannelData* channel_data, Channel& channel)
+{
+	if (mGlitchWidth < 2 || !channel_data->WouldAdvancingCauseTransition(mGlitchWidth - 1))
+		return false;
+	if (mErrorMarkers)
+		mResults->AddMarker(channel_data->GetSampleNumber(), AnalyzerResults::ErrorDot, channel);
+	channel_data->AdvanceToNextEdge();
+	mGlitchCount++;
+	return true;
+}
+
+//Function to advance a high line to the falling edge of the next start bit, glitches are skipped
+void LuosAnalyzer::AdvanceToStartBit(AnalyzerChannelData* channel_data, Channel& channel)
+{
+	do {
+		channel_data->AdvanceToNextEdge();
+	} while (SkipGlitch(channel_data, channel));
+}
+
+/*Function to advance a line to a point followed by a timeout period without edges.
+The characters met on the way are skipped whole: from the center of their start bit straight to their stop bit, whatever their data.
+The cost is a few channel calls per character instead of two per edge, a low stop bit (framing error) costs one more edge*/
+void LuosAnalyzer::SkipToIdle(AnalyzerChannelData* channel_data)
+{
+	for ( ; ; )
+	{
+		CheckIfThreadShouldExit();
+		if (channel_data->GetBitState() == BIT_LOW)
+			channel_data->AdvanceToNextEdge();
+		if (!channel_data->WouldAdvancingCauseTransition(mTimeout))
+			return;
+		//the next edge starts a character, unless the line is high again at the center of the start bit (glitch)
+		U64 start_sample = channel_data->GetSampleOfNextEdge();
+		channel_data->AdvanceToAbsPosition(start_sample + SamplePoint(0));
+		if (channel_data->GetBitState() == BIT_LOW)
+			channel_data->AdvanceToAbsPosition(start_sample + SamplePoint(9));
+	}
+}
+
+/*Function to decode the next character of a message - the channel is either on a start bit or after a stop bit.
+Returns false with an error marker if no character starts before the timeout or on a framing error*/
+bool LuosAnalyzer::ReadNextByte(AnalyzerChannelData* channel_data, Channel& channel, AnalyzerResults::MarkerType marker, U64& start_sample, U8& byte)
+{
+	if (channel_data->GetBitState() == BIT_HIGH) {
+		do {
+			//if there's no edge for the duration of timeout -> reset
+			if (!channel_data->WouldAdvancingCauseTransition(mTimeout)) {
+				if (mErrorMarkers)
+					mResults->AddMarker(channel_data->GetSampleNumber(), AnalyzerResults::ErrorX, channel);
+				return false;
 			}
+			channel_data->AdvanceToNextEdge();
+		} while (SkipGlitch(channel_data, channel));
+	}
+	start_sample = channel_data->GetSampleNumber();
+	if (!ReadByte(channel_data, channel, marker, byte)) {
+		if (mErrorMarkers)
+			mResults->AddMarker(channel_data->GetSampleNumber(), AnalyzerResults::ErrorX, channel);
+		return false;
+	}
+	return true;
+}
+
+/*Function to decode the next character of a message in Tx/Rx config.
+A msg sent in Tx is echoed in Rx: if both characters are not equal -> collision detection, after which the data of Rx are monitored*/
+bool LuosAnalyzer::ReadTxRxByte(bool& Rx_msg, bool& collision_detection, U64& start_sample, U8& byte)
+{
+	if (Rx_msg) {
+		if (!ReadNextByte(mRx, mSettings->mRxChannel, AnalyzerResults::Dot, start_sample, byte))
+			return false;
+		if (collision_detection && mErrorMarkers)			//add error X
+			mResults->AddMarker(start_sample + SamplePoint(1), AnalyzerResults::ErrorX, mSettings->mTxChannel);
+		return true;
+	}
+
+	if (!ReadNextByte(mTx, mSettings->mTxChannel, AnalyzerResults::Dot, start_sample, byte))
+		return false;
+
+	//square - character received by Rx, it starts less than a bit after the Tx one
+	U64 echo_limit = start_sample + BitSamples(1);
+	if (mRx->GetBitState() == BIT_HIGH && mRx->GetSampleNumber() < echo_limit && mRx->WouldAdvancingToAbsPositionCauseTransition(echo_limit)) {
+		mRx->AdvanceToNextEdge();
+		SkipGlitch(mRx, mSettings->mRxChannel);
+	}
+	if (mRx->GetBitState() == BIT_LOW) {
+		U8 received_byte;
+		if (!ReadByte(mRx, mSettings->mRxChannel, AnalyzerResults::Square, received_byte)) {
+			if (mErrorMarkers)
+				mResults->AddMarker(mRx->GetSampleNumber(), AnalyzerResults::ErrorX, mSettings->mRxChannel);
+			return false;
+		}
+		if (received_byte != byte) {
+			collision_detection = 1;
+			Rx_msg = 1;
+			byte = received_byte;
 		}
 	}
+	return true;
 }
 
-/*Function to compute CRC value - Called every 8 bits*/
-void ComputeCRC(uint8_t data) {
+/*Function to measure the bit rate on the first pulses of the lines. The shortest pulse is a single bit: the pulses shorter than
+the glitch filter are left out, and the shortest one is only taken if another pulse is less than an eighth longer, so a lone spike
+does not give the bit. The pulses less than 1.5 times longer are averaged, then the rate is snapped to the nearest standard one
+if it is less than 5% away and kept in the range of the bit rate setting. Returns 0 if there is no pulse*/
+U32 LuosAnalyzer::MeasureBitRate()
+{
+	U64 widths[LUOS_AUTOBAUD_PULSES];
+	U64 bit_samples = 0;
+	U32 bits = 0;
+
+	AnalyzerChannelData* lines[2] = { mTx, NULL };
+	if (mSettings->mRxChannel != UNDEFINED_CHANNEL)
+		lines[1] = GetAnalyzerChannelData(mSettings->mRxChannel);
+	for (U32 i = 0; i < 2 && lines[i] != NULL; i++)
+	{
+		U32 pulses = RecordPulses(lines[i], widths, LUOS_AUTOBAUD_PULSES);
+		std::sort(widths, widths + pulses);
+		U32 shortest = 0;
+		while (shortest < pulses && widths[shortest] < mSettings->mGlitchFilter)
+			shortest++;
+		while (shortest + 1 < pulses && widths[shortest + 1] > widths[shortest] + widths[shortest] / 8 + 1)
+			shortest++;
+		if (shortest + 1 >= pulses)
+			continue;
+		for (U32 pulse = shortest; pulse < pulses && 2 * widths[pulse] < 3 * widths[shortest]; pulse++)
+		{
+			bit_samples += widths[pulse];
+			bits++;
+		}
+	}
+	if (bits == 0)
+		return 0;
 
-	uint16_t dbyte = data;
-	crc_val ^= dbyte << 8;
-	for (uint8_t j = 0; j < 8; j++)
+	double bit_rate = double(mSampleRateHz) * bits / double(bit_samples);
+	double best_error = 0.05;
+	U32 snapped_rate = U32(bit_rate + 0.5);
+	for (U32 i = 0; i < sizeof(LUOS_BIT_RATES) / sizeof(LUOS_BIT_RATES[0]); i++)
 	{
-		uint16_t mix = crc_val & 0x8000;
-		crc_val = (crc_val << 1);
-		if (mix)
-			crc_val = crc_val ^ 0x0007;
+		double error = bit_rate / LUOS_BIT_RATES[i] - 1.0;
+		if (error < 0)
+			error = -error;
+		if (error < best_error) {
+			best_error = error;
+			snapped_rate = LUOS_BIT_RATES[i];
+		}
 	}
+	if (bit_rate > LUOS_MAX_BIT_RATE)
+		return LUOS_MAX_BIT_RATE;
+	return snapped_rate < LUOS_MIN_BIT_RATE ? LUOS_MIN_BIT_RATE : snapped_rate;
+}
+
+//Function to record the widths of the first complete pulses of a line in the data already captured, returns their number
+U32 LuosAnalyzer::RecordPulses(AnalyzerChannelData* channel_data, U64* widths, U32 max_pulses)
+{
+	U32 pulses = 0;
+	if (!channel_data->DoMoreTransitionsExistInCurrentData())
+		return 0;
+	channel_data->AdvanceToNextEdge();
+	U64 edge = channel_data->GetSampleNumber();
+	while (pulses < max_pulses && channel_data->DoMoreTransitionsExistInCurrentData())
+	{
+		CheckIfThreadShouldExit();
+		channel_data->AdvanceToNextEdge();
+		widths[pulses++] = channel_data->GetSampleNumber() - edge;
+		edge = channel_data->GetSampleNumber();
+	}
+	return pulses;
 }
 
 bool LuosAnalyzer::NeedsRerun()
 {
+	//auto baud: the run after the measure decodes the capture, the detected rate is shown in the settings
+	if (mBitRateMeasured) {
+		mBitRateMeasured = false;
+		if (mMeasuredBitRate != 0) {
+			mSettings->mBitRate = mMeasuredBitRate;
+			mSettings->UpdateInterfacesFromSettings();
+		}
+		return true;
+	}
+	//the next capture is measured again
+	mMeasureBitRate = true;
 	return false;
 }
 
@@ -2071,7 +839,8 @@ U32 LuosAnalyzer::GenerateSimulationData(U64 minimum_sample_index, U32 device_sa
 
 U32 LuosAnalyzer::GetMinimumSampleRateHz()
 {
-	return mSettings->mBitRate * 4;
+	//bits are read from the edges with a fractional bit period: 3 samples per bit keep the sample point a sample away from the edges
+	return mSettings->mBitRate * 3;
 }
 
 const char* LuosAnalyzer::GetAnalyzerName() const
@@ -4,7 +4,13 @@
 #include <Analyzer.h>
 #include "LuosAnalyzerResults.h"
 #include "LuosSimulationDataGenerator.h"
+#include "LuosDecoderContext.h"
+#include "LuosMessageStore.h"
 #include <stdint.h>
+#include <chrono>
+
+//fractional bits of the bit timing, the sample point error stays below one sample over a whole character
+#define LUOS_BIT_FRACTION 16
 
 class LuosAnalyzerSettings;
 class ANALYZER_EXPORT LuosAnalyzer : public Analyzer2
@@ -22,36 +28,84 @@ public:
 	virtual const char* GetAnalyzerName() const;
 	virtual bool NeedsRerun();
 
+	U64 GetGlitchCount() const { return mGlitchCount; }
+	const LuosMessageStore& GetMessageStore() const { return mMessages; }
+
+protected: //functions
+	//character timing - bit 0 is the start bit, bit 9 the stop bit
+	U64 BitSamples( U32 bits ) const { return ( bits * mBitPeriod ) >> LUOS_BIT_FRACTION; }
+	U64 SamplePoint( U32 bit ) const { return ( bit * mBitPeriod + mSampleOffset ) >> LUOS_BIT_FRACTION; }
+
+	template< class ChannelPolicy > void Decode();
+	void AddFieldFrame( U64 label, U64 data, U64 starting_sample, U64 ending_sample, U8 type = FIELD_FRAME, U8 flags = 0 );
+	void AddHeaderFrames( U32 first_byte, U32 end_byte );
+	void AddPayloadFrame();
+	void AddToTransaction( U64 packet_id );
+	void AddFragment( LuosTransfer& transfer );
+	void CommitFrames();
+	bool ReadByte( AnalyzerChannelData* channel_data, Channel& channel, AnalyzerResults::MarkerType marker, U8& byte );
+	bool ReadNextByte( AnalyzerChannelData* channel_data, Channel& channel, AnalyzerResults::MarkerType marker, U64& start_sample, U8& byte );
+	bool ReadTxRxByte( bool& Rx_msg, bool& collision_detection, U64& start_sample, U8& byte );
+	U64 NextEdge( AnalyzerChannelData* channel_data, BitState bit_state, U64 limit );
+	bool SkipGlitch( AnalyzerChannelData* channel_data, Channel& channel );
+	void AdvanceToStartBit( AnalyzerChannelData* channel_data, Channel& channel );
+	void SkipToIdle( AnalyzerChannelData* channel_data );
+	U32 MeasureBitRate();
+	U32 RecordPulses( AnalyzerChannelData* channel_data, U64* widths, U32 max_pulses );
+
+	//channel policies of the decoder, defined with it
+	class OneWirePolicy;
+	class TxRxPolicy;
+
 protected: //vars
 	std::auto_ptr< LuosAnalyzerSettings > mSettings;
 	std::auto_ptr< LuosAnalyzerResults > mResults;
 	AnalyzerChannelData* mTx;
 	AnalyzerChannelData* mRx;
 
+	LuosDecoderContext mContext;
+	LuosMessageStore mMessages;     //raw bytes of the msgs, by packet id
+
 	LuosSimulationDataGenerator mSimulationDataGenerator;
 	bool mSimulationInitilized;
 
 	//Serial analysis vars:
 	U32 mSampleRateHz;
-	U32 mStartOfStopBitOffset;
-	U32 mEndOfStopBitOffset;
-};
+	U64 mBitPeriod;             //samples per bit, LUOS_BIT_FRACTION fractional bits
+	U64 mSampleOffset;          //sample point from the beginning of a bit, same fixed point
+	U32 mTimeout;
+	U64 mResponseTimeout;       //samples from the end of a request to the start of its response
 
-//void One_Wire_Config();
+	//noise
+	U32 mGlitchWidth;           //pulses shorter than this are ignored, 0: no filter
+	U32 mVotes;                 //samples per bit: 1, or 3 with the majority vote
+	U64 mVoteOffset;
+	U64 mGlitchCount;           //glitches filtered in the capture
+	U64 mFrameGlitchCount;      //glitch count when the last frame was added
 
-void ComputeCRC (uint8_t data);
+	//auto baud
+	bool mMeasureBitRate;       //the next run measures the bit rate
+	bool mBitRateMeasured;      //the last run measured it, the decoding needs a rerun
+	U32 mMeasuredBitRate;
 
-typedef enum { PROTOCOL,
-							 TARGET,
-						 	 TARGET_MODE,
-						   SOURCE,
-						   CMD,
-						   SIZE,
-							 DATA,
-						 	 CRC,
-						   ACK,
-						 	 WAIT }pos_state;
+	//markers kept by the density setting
+	bool mBitMarkers;
+	bool mByteMarkers;
+	bool mTimeoutMarkers;
+	bool mErrorMarkers;
+	bool mCompactHeader;        //one frame for the whole header
+	U32 mPayloadBytes;          //payload bytes per frame
 
+	//result updates: frames are committed per msg, the progress at most mUpdateRate times per second
+	U64 mUpdatePeriod;          //samples
+	U32 mPendingFrames;
+	U64 mPendingStart;
+	U64 mLastFrameSample;
+	std::chrono::steady_clock::duration mProgressPeriod;
+	std::chrono::steady_clock::time_point mNextProgress;
+};
+
+//void One_Wire_Config();
 
 extern "C" ANALYZER_EXPORT const char* __cdecl GetAnalyzerName();
 extern "C" ANALYZER_EXPORT Analyzer* __cdecl CreateAnalyzer( );
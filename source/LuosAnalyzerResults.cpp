@@ -2,11 +2,15 @@
 #include <AnalyzerHelpers.h>
 #include "LuosAnalyzer.h"
 #include "LuosAnalyzerSettings.h"
+#include "LuosExportFile.h"
+#include "LuosExportPool.h"
+#include "LuosBinaryWriter.h"
+#include "LuosPcapngWriter.h"
 #include <iostream>
-#include <fstream>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sstream>
+#include <iomanip>
 #include <string.h>
 
 
@@ -23,439 +27,892 @@ LuosAnalyzerResults::~LuosAnalyzerResults()
 {
 }
 
-std::string DataTranslation(U64 frame_data1, U64 frame_data2, DisplayBase display_base);
+//names shown with the field values - indexed by value
+static constexpr const char* LUOS_MODE_NAMES[] = { "ID", "IDACK", "TYPE", "BROADCAST", "MULTICAST", "NODEID", "NODEIDACK" };
+static constexpr const char* LUOS_CMD_NAMES[] = {
+	"WRITE_NODE_ID", "RESET_DETECTION", "SET_BAUDRATE", "ASSERT", "RTB_CMD", "WRITE_ALIAS", "UPDATE_PUB", "NODE_UUID",
+	"REVISION", "LUOS_REVISION", "LUOS_STATISTICS", "ASK_PUB_CMD", "COLOR", "COMPLIANT", "IO_STATE", "RATIO",
+	"PEDOMETER", "ILLUMINANCE", "VOLTAGE", "CURRENT", "POWER", "TEMPERATURE", "TIME", "FORCE",
+	"MOMENT", "CONTROL", "REGISTER", "REINIT", "PID", "RESOLUTION", "REDUCTION", "DIMENSION",
+	"OFFSET", "SETID", "ANGULAR_POSITION", "ANGULAR_SPEED", "LINEAR_POSITION", "LINEAR_SPEED", "ACCEL_3D", "GYRO_3D",
+	"QUATERNION", "COMPASS_3D", "EULER_3D", "ROT_MAT", "LINEAR_ACCEL", "GRAVITY_VECTOR", "HEADING", "ANGULAR_POSITION_LIMIT",
+	"LINEAR_POSITION_LIMIT", "RATIO_LIMIT", "CURRENT_LIMIT", "ANGULAR_SPEED_LIMIT", "LINEAR_SPEED_LIMIT", "TORQUE_LIMIT", "DXL_WHEELMODE", "HANDY_SET_POSITION",
+	"PARAMETERS", "LUOS_PROTOCOL_NB" };
+//ack values 0x0F, 0x1F, 0x2F, 0x3F
+static constexpr const char* LUOS_ACK_NAMES[] = { "ACK", "NAK", "ACK TIMEOUT", "ACK FRAMING ERROR" };
+
+static_assert( sizeof( LUOS_MODE_NAMES ) / sizeof( LUOS_MODE_NAMES[ 0 ] ) == MODE_NODEIDACK + 1, "a name for each target mode" );
+static_assert( sizeof( LUOS_CMD_NAMES ) / sizeof( LUOS_CMD_NAMES[ 0 ] ) == 58, "a name for each command" );
+
+//text written in a fixed buffer, no allocation - the text is cut if it does not fit
+class LuosText
+{
+public:
+	LuosText( char* text, U32 size ) : mText( text ), mSize( size ), mLength( 0 ) { mText[ 0 ] = 0; }
+
+	LuosText& operator<<( const char* text )
+	{
+		while( *text != 0 && mLength + 1 < mSize )
+			mText[ mLength++ ] = *text++;
+		mText[ mLength ] = 0;
+		return *this;
+	}
+
+	LuosText& operator<<( char c )
+	{
+		char text[ 2 ] = { c, 0 };
+		return *this << text;
+	}
+
+	LuosText& Number( U64 value, DisplayBase display_base, U32 bit_num )
+	{
+		if( display_base == Decimal )
+			return Unsigned( value );
+		char number_str[ 128 ];
+		AnalyzerHelpers::GetNumberString( value, display_base, bit_num, number_str, 128 );
+		return *this << number_str;
+	}
+
+	LuosText& Unsigned( U64 value )
+	{
+		char digits[ 21 ];
+		U32 i = 20;
+		digits[ i ] = 0;
+		do
+		{
+			digits[ --i ] = char( '0' + value % 10 );
+			value /= 10;
+		} while( value != 0 );
+		return *this << digits + i;
+	}
+
+	//seconds from the trigger with 9 decimals, integer arithmetic only
+	LuosText& Time( U64 sample, U64 trigger_sample, U32 sample_rate )
+	{
+		U64 samples = sample >= trigger_sample ? sample - trigger_sample : trigger_sample - sample;
+		if( sample < trigger_sample )
+			*this << '-';
+		Unsigned( samples / sample_rate ) << '.';
+		U64 nanoseconds = ( samples % sample_rate ) * 1000000000ull / sample_rate;
+		char digits[ 10 ];
+		for( int i = 8; i >= 0; i-- )
+		{
+			digits[ i ] = char( '0' + nanoseconds % 10 );
+			nanoseconds /= 10;
+		}
+		digits[ 9 ] = 0;
+		return *this << digits;
+	}
+
+	//a csv value, quoted if it holds a separator
+	LuosText& Csv( const char* value )
+	{
+		if( strpbrk( value, ",\"\n" ) == NULL )
+			return *this << value;
+		*this << '"';
+		for( ; *value != 0; value++ )
+		{
+			if( *value == '"' )
+				*this << '"';
+			*this << *value;
+		}
+		return *this << '"';
+	}
+
+	LuosText& Hex( U8 value )
+	{
+		static constexpr char digits[] = "0123456789ABCDEF";
+		return *this << digits[ value >> 4 ] << digits[ value & 0x0F ];
+	}
+
+	//ends the current string, the next text starts a new one
+	LuosText& Next()
+	{
+		if( mLength + 1 < mSize )
+			mText[ ++mLength ] = 0;
+		return *this;
+	}
+
+	void Clear()
+	{
+		mLength = 0;
+		mText[ 0 ] = 0;
+	}
+
+	const char* GetText() const { return mText; }
+	U32 GetLength() const { return mLength; }
+	//bytes used by all the strings and the end of the last one
+	U32 GetSize() const { return mLength + 1; }
+
+protected:
+	char* mText;
+	U32 mSize;
+	U32 mLength;
+};
+
+void DataTranslation( U64 frame_data1, U64 frame_data2, DisplayBase display_base, LuosText& text );
+void FrameTranslation( const Frame& frame, DisplayBase display_base, LuosText& text );
+void ShortTranslations( const Frame& frame, DisplayBase display_base, LuosText& text );
+LuosText& FieldValue( U64 label, U64 value, DisplayBase display_base, LuosText& text );
+void ExportFrame( const Frame& frame, U64 trigger_sample, U32 sample_rate, DisplayBase display_base, std::string& out );
+void ExportMessage( const LuosMessageStore& messages, U64 message_id, U64 trigger_sample, U32 sample_rate, DisplayBase display_base, std::string& out );
+
+//frames exported between two progress updates
+#define LUOS_EXPORT_PROGRESS_FRAMES 1024
 
 void LuosAnalyzerResults::GenerateBubbleText( U64 frame_index, Channel& channel, DisplayBase display_base )
 {
 	ClearResultStrings();
-	std::stringstream ss;
+	char buffer[ LUOS_TEXT_SIZE ];
 
-	Frame frame = GetFrame( frame_index );
-
-	ss << DataTranslation(frame.mData1, frame.mData2, display_base);
+	//the same bubbles are asked again on every pan and zoom
+	U32 size = mBubbleCache.Find( frame_index, display_base, buffer );
+	if( size == 0 )
+	{
+		LuosText text( buffer, LUOS_TEXT_SIZE );
+		Frame frame = GetFrame( frame_index );
+
+		//shortest first, Logic shows the longest one that fits
+		ShortTranslations( frame, display_base, text );
+		FrameTranslation( frame, display_base, text );
+		size = text.GetSize();
+		mBubbleCache.Add( frame_index, display_base, buffer, size );
+	}
 
-	AddResultString( ss.str().c_str() );
+	for( const char* result = buffer; result < buffer + size; result += strlen( result ) + 1 )
+		AddResultString( result );
 }
 
 void LuosAnalyzerResults::GenerateExportFile( const char* file, DisplayBase display_base, U32 export_type_user_id )
 {
-	std::ofstream file_stream( file, std::ios::out );
+	switch( export_type_user_id )
+	{
+		case EXPORT_MESSAGES:
+			ExportMessages( file, display_base );
+			break;
+		case EXPORT_BINARY:
+			ExportBinary( file );
+			break;
+		case EXPORT_PCAPNG:
+			ExportPcapng( file );
+			break;
+		case EXPORT_TRANSFERS:
+			ExportTransfers( file, display_base );
+			break;
+		case EXPORT_SUMMARY:
+			ExportSummary( file );
+			break;
+		default:
+			ExportFields( file, display_base );
+			break;
+	}
+}
+
+//formats the chunks of count frames or msgs on the pool and writes them in order, false if the export is cancelled
+//prepare runs on this thread before a chunk is submitted, for what only the sdk can give
+bool LuosAnalyzerResults::WriteChunks( LuosExportFile& export_file, LuosExportPool& pool, U64 count, const std::function< void( U32 slot, U64 chunk ) >& prepare )
+{
+	U64 chunks = ( count + LUOS_EXPORT_CHUNK_SIZE - 1 ) / LUOS_EXPORT_CHUNK_SIZE;
+	U64 submitted = 0;
+	for( U64 written = 0; written < chunks; written++ )
+	{
+		for( ; submitted < chunks && submitted < written + pool.GetWindow(); submitted++ )
+		{
+			if( prepare )
+				prepare( U32( submitted % pool.GetWindow() ), submitted );
+			pool.Submit( submitted );
+		}
+
+		const std::string& text = pool.Wait( written );
+		if( !text.empty() )
+			export_file.Write( text.data(), U32( text.size() ) );
+
+		U64 done = ( written + 1 ) * LUOS_EXPORT_CHUNK_SIZE;
+		if( UpdateExportProgressAndCheckForCancel( done < count ? done : count, count ) == true )
+			return false;
+	}
+	return true;
+}
+
+//a row per field, the transfers and the glitch count have their own exports
+void LuosAnalyzerResults::ExportFields( const char* file, DisplayBase display_base )
+{
+	LuosExportFile export_file( file );
 
 	U64 trigger_sample = mAnalyzer->GetTriggerSample();
 	U32 sample_rate = mAnalyzer->GetSampleRate();
+	char line_str[ LUOS_TEXT_SIZE ];
+	LuosText line( line_str, LUOS_TEXT_SIZE );
 
-	file_stream << "Time [s],Value" << std::endl;
+	line << "Time [s],Field,Value,Name\n";
+	export_file.Write( line_str, line.GetLength() );
 
+	//the frames of a chunk are read here, the pool only formats them
 	U64 num_frames = GetNumFrames();
-	for( U32 i=0; i < num_frames; i++ )
+	std::vector< std::vector< Frame > > frames;
+	LuosExportPool pool( [ & ]( U32 slot, U64, std::string& text ) {
+		for( U32 i = 0; i < frames[ slot ].size(); i++ )
+			ExportFrame( frames[ slot ][ i ], trigger_sample, sample_rate, display_base, text );
+	} );
+	frames.resize( pool.GetWindow() );
+	WriteChunks( export_file, pool, num_frames, [ & ]( U32 slot, U64 chunk ) {
+		U64 first = chunk * LUOS_EXPORT_CHUNK_SIZE;
+		U64 end = first + LUOS_EXPORT_CHUNK_SIZE < num_frames ? first + LUOS_EXPORT_CHUNK_SIZE : num_frames;
+		frames[ slot ].clear();
+		for( U64 i = first; i < end; i++ )
+			frames[ slot ].push_back( GetFrame( i ) );
+	} );
+}
+
+//a row per msg, read from the message store by the pool: the frames are not parsed again
+void LuosAnalyzerResults::ExportMessages( const char* file, DisplayBase display_base )
+{
+	LuosExportFile export_file( file );
+
+	U64 trigger_sample = mAnalyzer->GetTriggerSample();
+	U32 sample_rate = mAnalyzer->GetSampleRate();
+	static const char header[] = "Start [s],End [s],Protocol,Target,Mode,Source,Cmd,Size,Payload,CRC,Ack,Ack latency [s]\n";
+	export_file.Write( header, sizeof( header ) - 1 );
+
+	const LuosMessageStore& messages = mAnalyzer->GetMessageStore();
+	U64 num_messages = messages.GetNumMessages();
+	LuosExportPool pool( [ & ]( U32, U64 chunk, std::string& text ) {
+		U64 first = chunk * LUOS_EXPORT_CHUNK_SIZE;
+		U64 end = first + LUOS_EXPORT_CHUNK_SIZE < num_messages ? first + LUOS_EXPORT_CHUNK_SIZE : num_messages;
+		for( U64 i = first; i < end; i++ )
+			ExportMessage( messages, i, trigger_sample, sample_rate, display_base, text );
+	} );
+	WriteChunks( export_file, pool, num_messages, nullptr );
+}
+
+//a row per msg reassembled from its fragments, in the order they start
+void LuosAnalyzerResults::ExportTransfers( const char* file, DisplayBase display_base )
+{
+	LuosExportFile export_file( file );
+
+	U64 trigger_sample = mAnalyzer->GetTriggerSample();
+	U32 sample_rate = mAnalyzer->GetSampleRate();
+	char row_str[ LUOS_TEXT_SIZE ];
+	LuosText row( row_str, LUOS_TEXT_SIZE );
+
+	row << "Start [s],End [s],Source,Target,Cmd,Size,Received,Fragments,Throughput [B/s],Status\n";
+	export_file.Write( row_str, row.GetLength() );
+
+	const LuosMessageStore& messages = mAnalyzer->GetMessageStore();
+	U64 num_transfers = messages.GetNumTransfers();
+	for( U64 i = 0; i < num_transfers; i++ )
 	{
-		Frame frame = GetFrame( i );
+		LuosTransfer transfer = messages.GetTransfer( i );
+		U64 samples = transfer.mEndSample - transfer.mStartSample;
+
+		row.Clear();
+		row.Time( transfer.mStartSample, trigger_sample, sample_rate ) << ",";
+		row.Time( transfer.mEndSample, trigger_sample, sample_rate ) << ",";
+		FieldValue( 'SRC', transfer.mSource, display_base, row ) << ",";
+		FieldValue( 'TRGT', transfer.mTarget, display_base, row ) << ",";
+		if( transfer.mCmd < sizeof( LUOS_CMD_NAMES ) / sizeof( LUOS_CMD_NAMES[ 0 ] ) )
+			row << LUOS_CMD_NAMES[ transfer.mCmd ] << ",";
+		else
+			row.Unsigned( transfer.mCmd ) << ",";
+		row.Unsigned( transfer.mSize ) << ",";
+		row.Unsigned( transfer.mReceived ) << ",";
+		row.Unsigned( transfer.mFragments ) << ",";
+		row.Unsigned( samples != 0 ? U64( transfer.mReceived ) * sample_rate / samples : 0 ) << ",";
+		row << ( transfer.mComplete ? "complete\n" : "incomplete\n" );
+		export_file.Write( row_str, row.GetLength() );
+
+		if( i % LUOS_EXPORT_PROGRESS_FRAMES == 0 && UpdateExportProgressAndCheckForCancel( i, num_transfers ) == true )
+			return;
+	}
+}
+
+//one name and value per row: what the capture holds besides its msgs
+void LuosAnalyzerResults::ExportSummary( const char* file )
+{
+	LuosExportFile export_file( file );
+	const LuosMessageStore& messages = mAnalyzer->GetMessageStore();
+	U64 num_transfers = messages.GetNumTransfers();
+	U64 incomplete = 0;
+	for( U64 i = 0; i < num_transfers; i++ )
+		if( !messages.GetTransfer( i ).mComplete )
+			incomplete++;
+
+	char text_str[ LUOS_TEXT_SIZE ];
+	LuosText text( text_str, LUOS_TEXT_SIZE );
+	text << "Name,Value\n";
+	text << "Messages,";
+	text.Unsigned( messages.GetNumMessages() ) << "\n";
+	text << "Transfers,";
+	text.Unsigned( num_transfers ) << "\n";
+	text << "Incomplete transfers,";
+	text.Unsigned( incomplete ) << "\n";
+	//noise filtered in the capture, the filter is off below 2 samples
+	text << "Glitch filter [samples],";
+	text.Unsigned( mSettings->mGlitchFilter > 1 ? mSettings->mGlitchFilter : 0 ) << "\n";
+	text << "Glitches filtered,";
+	text.Unsigned( mAnalyzer->GetGlitchCount() ) << "\n";
+	export_file.Write( text_str, text.GetLength() );
+}
 
-		char time_str[128];
-		AnalyzerHelpers::GetTimeString( frame.mStartingSampleInclusive, trigger_sample, sample_rate, time_str, 128 );
-		
-		char number_str[128];
-		AnalyzerHelpers::GetNumberString( frame.mData1, display_base, 8, number_str, 128 );
+//the msgs of the message store in binary columns, the display base does not apply
+void LuosAnalyzerResults::ExportBinary( const char* file )
+{
+	LuosBinaryWriter writer( file, mAnalyzer->GetTriggerSample(), mAnalyzer->GetSampleRate() );
 
-		file_stream << time_str << "," << number_str << std::endl;
+	const LuosMessageStore& messages = mAnalyzer->GetMessageStore();
+	U64 num_messages = messages.GetNumMessages();
+	for( U64 i = 0; i < num_messages; i++ )
+	{
+		const U8* bytes;
+		LuosMessageInfo info;
+		U32 size = messages.GetMessage( i, &bytes, &info );
+		if( size >= LUOS_HEADER_SIZE )
+			writer.AddMessage( bytes, size, info );
 
-		if( UpdateExportProgressAndCheckForCancel( i, num_frames ) == true )
-		{
-			file_stream.close();
+		if( i % LUOS_EXPORT_PROGRESS_FRAMES == 0 && UpdateExportProgressAndCheckForCancel( i, num_messages ) == true )
 			return;
-		}
 	}
 
-	file_stream.close();
+	writer.Close();
+}
+
+//a packet per msg of the message store, decoded in Wireshark by wireshark/luos.lua
+void LuosAnalyzerResults::ExportPcapng( const char* file )
+{
+	LuosPcapngWriter writer( file, mAnalyzer->GetSampleRate() );
+
+	const LuosMessageStore& messages = mAnalyzer->GetMessageStore();
+	U64 num_messages = messages.GetNumMessages();
+	for( U64 i = 0; i < num_messages; i++ )
+	{
+		const U8* bytes;
+		LuosMessageInfo info;
+		U32 size = messages.GetMessage( i, &bytes, &info );
+		if( size >= LUOS_HEADER_SIZE )
+			writer.AddMessage( bytes, size, info );
+
+		if( i % LUOS_EXPORT_PROGRESS_FRAMES == 0 && UpdateExportProgressAndCheckForCancel( i, num_messages ) == true )
+			return;
+	}
 }
 
 void LuosAnalyzerResults::GenerateFrameTabularText( U64 frame_index, DisplayBase display_base )
 {
 #ifdef SUPPORTS_PROTOCOL_SEARCH
 	Frame frame = GetFrame( frame_index );
-	std::stringstream ss;
+	char buffer[ LUOS_TEXT_SIZE ];
+	LuosText text( buffer, LUOS_TEXT_SIZE );
 
 	ClearTabularText();
 
-	ss << DataTranslation(frame.mData1, frame.mData2, display_base);
+	FrameTranslation( frame, display_base, text );
 
-	AddTabularText( ss.str().c_str() );
+	AddTabularText( text.GetText() );
 
 #endif
 }
 
-//function that translates the data to the desired display format
-std::string DataTranslation( U64 frame_data1, U64 frame_data2,  DisplayBase display_base) {
-	std::stringstream ss;   //returned string
-	char number_str[128];   //string from label
-	char number_str2[128];  //string from data
-	U32 bit_num=8;
-
-	AnalyzerHelpers::GetNumberString( frame_data1, ASCII, 8, number_str, 128 );
-
-	switch (frame_data1) {  //choose how many bits will represent its value
-		case 'PROT': {
-			bit_num = 4;
+//function that translates a frame of any type: the fields packed in header and payload frames are unpacked
+void FrameTranslation( const Frame& frame, DisplayBase display_base, LuosText& text ) {
+	switch (LUOS_FRAME_KIND(frame.mType)) {
+		case HEADER_FRAME: {    //every field of the header in mData1
+			for (U32 i = 0; i < HEADER_FIELDS; i++) {
+				const LuosHeaderField& field = LUOS_HEADER_LAYOUT[i];
+				if (i != 0)
+					text << ", ";
+				DataTranslation(field.mLabel, field.Extract(frame.mData1), display_base, text);
+			}
 			break;
 		}
-		case 'TRGT': {
-			bit_num = 12;
+		case PAYLOAD_FRAME: {   //hex then ascii run of the bytes
+			U8 bytes[LUOS_PAYLOAD_MAX_BYTES];
+			U32 count = LuosPayloadBytes(frame, bytes);
+			U32 first = LuosPayloadIndex(frame);
+			text << "DATA[";
+			text.Number(first, Decimal, 32) << "-";
+			text.Number(first + count - 1, Decimal, 32) << "] =";
+			for (U32 i = 0; i < count; i++) {
+				text << ' ';
+				text.Hex(bytes[i]);
+			}
+			text << " \"";
+			for (U32 i = 0; i < count; i++)
+				text << ((bytes[i] >= 0x20 && bytes[i] < 0x7F) ? char(bytes[i]) : '.');
+			text << "\"";
+			break;
+		}
+		default: {
+			DataTranslation(frame.mData1, frame.mData2, display_base, text);
 			break;
 		}
+	}
+}
+
+//value of a field with its width, the size is always decimal
+LuosText& FieldValue( U64 label, U64 value, DisplayBase display_base, LuosText& text ) {
+	switch (label) {
+		case 'PROT':
 		case 'MODE': {
-			bit_num = 4;
+			text.Number(value, display_base, 4);
 			break;
 		}
+		case 'TRGT':
 		case 'SRC': {
-			bit_num = 12;
+			text.Number(value, display_base, 12);
 			break;
 		}
-		case 'CMD': {
-			bit_num = 8;
+		case 'SIZE': {
+			text.Number(value, Decimal, 16);
 			break;
 		}
-		case 'SIZE': {
-			bit_num = 16;
+		case 'CRC':
+		case 'NOT': {
+			text.Number(value, display_base, 16);
 			break;
 		}
-		case 'CRC': {
-			bit_num = 16;
+		default: {
+			text.Number(value, display_base, 8);
 			break;
 		}
-		case 'NOT': {
-			bit_num = 16;
+	}	return text;
+}
+
+//a cmd name cut to 3 letters per word: ANGULAR_POSITION -> ANG_POS
+void CmdAbbreviation( U64 cmd, LuosText& text ) {
+	if (cmd >= sizeof(LUOS_CMD_NAMES) / sizeof(LUOS_CMD_NAMES[0])) {
+		text << "C ";
+		text.Number(cmd, Decimal, 8);
+		return;
+	}
+	U32 letters = 0;
+	for (const char* c = LUOS_CMD_NAMES[cmd]; *c != 0; c++) {
+		if (*c == '_')
+			letters = 0;
+		else if (++letters > 3)
+			continue;
+		text << *c;
+	}
+}
+
+//the shorter bubbles of a frame, each one ended: a tag, the value then a short form of the full text
+void ShortTranslations( const Frame& frame, DisplayBase display_base, LuosText& text ) {
+	switch (LUOS_FRAME_KIND(frame.mType)) {
+		case HEADER_FRAME: {    //route then route and cmd
+			U64 source = LUOS_HEADER_LAYOUT[HEADER_SOURCE].Extract(frame.mData1);
+			U64 target = LUOS_HEADER_LAYOUT[HEADER_TARGET].Extract(frame.mData1);
+			text << "H";
+			text.Next();
+			FieldValue('SRC', source, display_base, text);
+			FieldValue('TRGT', target, display_base, text << ">");
+			text.Next();
+			FieldValue('SRC', source, display_base, text);
+			FieldValue('TRGT', target, display_base, text << ">");
+			CmdAbbreviation(LUOS_HEADER_LAYOUT[HEADER_CMD].Extract(frame.mData1), text << " ");
+			text.Next();
+			break;
+		}
+		case PAYLOAD_FRAME: {   //byte range then the hex run
+			U8 bytes[LUOS_PAYLOAD_MAX_BYTES];
+			U32 count = LuosPayloadBytes(frame, bytes);
+			U32 first = LuosPayloadIndex(frame);
+			text << "D";
+			text.Next() << "[";
+			text.Number(first, Decimal, 32) << "-";
+			text.Number(first + count - 1, Decimal, 32) << "]";
+			text.Next();
+			for (U32 i = 0; i < count; i++) {
+				if (i != 0)
+					text << ' ';
+				text.Hex(bytes[i]);
+			}
+			text.Next();
+			break;
+		}
+		default: {
+			char value_str[128];
+			LuosText value(value_str, sizeof(value_str));
+			FieldValue(frame.mData1, frame.mData2, display_base, value);
+			switch (frame.mData1) {
+				case 'ACK': {
+					U64 ack = frame.mData2 >> 4;
+					text << "A";
+					text.Next() << value_str;
+					text.Next();
+					if ((frame.mData2 & 0x0F) == 0x0F && ack < sizeof(LUOS_ACK_NAMES) / sizeof(LUOS_ACK_NAMES[0]))
+						text << LUOS_ACK_NAMES[ack];
+					else
+						text << "A " << value_str;
+					break;
+				}
+				case 'MODE': {
+					text << "M";
+					text.Next() << value_str;
+					text.Next();
+					if (frame.mData2 <= MODE_NODEIDACK)
+						text << LUOS_MODE_NAMES[frame.mData2];
+					else
+						text << "M " << value_str;
+					break;
+				}
+				case 'CMD': {
+					text << "C";
+					text.Next() << value_str;
+					text.Next();
+					CmdAbbreviation(frame.mData2, text);
+					break;
+				}
+				case 'CRC':
+				case 'NOT': {
+					text << "CRC";
+					text.Next() << (frame.mData1 == 'CRC' ? "CRC OK" : "CRC BAD");
+					text.Next() << "CRC " << value_str << (frame.mData1 == 'CRC' ? " OK" : " BAD");
+					break;
+				}
+				case 'PROT':
+				case 'TRGT':
+				case 'SRC':
+				case 'SIZE': {
+					const char* tag = frame.mData1 == 'PROT' ? "P" : frame.mData1 == 'TRGT' ? "T" : frame.mData1 == 'SRC' ? "S" : "SZ";
+					text << tag;
+					text.Next() << value_str;
+					text.Next() << tag << " " << value_str;
+					break;
+				}
+				default: {      //payload byte: its value then its index
+					text << value_str;
+					text.Next() << "[";
+					text.Number(frame.mData1, Decimal, 8) << "] " << value_str;
+					break;
+				}
+			}
+			text.Next();
+			break;
+		}
+	}
+}
+
+//name of a field in the export, a payload byte is named by its index
+void FieldName( U64 label, LuosText& text ) {
+	switch (label) {
+		case 'PROT': text << "PROTOCOL"; break;
+		case 'TRGT': text << "TARGET"; break;
+		case 'MODE': text << "TARGET MODE"; break;
+		case 'SRC': text << "SOURCE"; break;
+		case 'CMD': text << "CMD"; break;
+		case 'SIZE': text << "SIZE"; break;
+		case 'CRC':
+		case 'NOT': text << "CRC"; break;
+		case 'ACK': text << "ACK"; break;
+		default: {
+			text << "DATA[";
+			text.Unsigned(label) << "]";
+			break;
+		}
+	}
+}
+
+//decoded name of a value, nothing if the field has none
+void ValueName( U64 label, U64 value, LuosText& text ) {
+	switch (label) {
+		case 'MODE': {
+			if (value <= MODE_NODEIDACK)
+				text << LUOS_MODE_NAMES[value];
 			break;
 		}
-		default:{
-			bit_num = 8;
+		case 'CMD': {
+			if (value < sizeof(LUOS_CMD_NAMES) / sizeof(LUOS_CMD_NAMES[0]))
+				text << LUOS_CMD_NAMES[value];
 			break;
 		}
+		case 'ACK': {
+			if ((value & 0x0F) == 0x0F && (value >> 4) < sizeof(LUOS_ACK_NAMES) / sizeof(LUOS_ACK_NAMES[0]))
+				text << LUOS_ACK_NAMES[value >> 4];
+			break;
+		}
+		case 'CRC': text << "GOOD"; break;
+		case 'NOT': text << "NOT GOOD"; break;
+		default: break;
 	}
+}
 
-	if (frame_data1 == 'SIZE') {	AnalyzerHelpers::GetNumberString( frame_data2, Decimal, bit_num, number_str2, 128 );	}
-	else {	AnalyzerHelpers::GetNumberString( frame_data2, display_base, bit_num, number_str2, 128 ); }
+//one csv row: time, field, value, name
+void ExportField( std::string& out, const char* time_str, U64 label, U64 value, DisplayBase display_base ) {
+	char row_str[LUOS_TEXT_SIZE];
+	LuosText row(row_str, LUOS_TEXT_SIZE);
+	char value_str[128];
+	LuosText value_text(value_str, sizeof(value_str));
+
+	FieldValue(label, value, display_base, value_text);
+	row << time_str << ",";
+	FieldName(label, row);
+	row << ",";
+	row.Csv(value_str) << ",";
+	ValueName(label, value, row);
+	row << "\n";
+	out.append(row_str, row.GetLength());
+}
 
+//the rows of a frame: the fields of a header frame and the bytes of a payload frame are exported one by one
+void ExportFrame( const Frame& frame, U64 trigger_sample, U32 sample_rate, DisplayBase display_base, std::string& out ) {
+	char time_str[32];
+	LuosText time(time_str, sizeof(time_str));
+	time.Time(frame.mStartingSampleInclusive, trigger_sample, sample_rate);
 
-	if (frame_data1 == 'ACK') {
-		switch(frame_data2) {
-			case 0x0F: {
-				ss << "ACK = " << number_str2;
-				break;
-			}
-			case 0x1F: {
-				ss << "NAK = " << number_str2;
-				break;
-			}
-			case 0x2F: {
-				ss << "ACK TIMEOUT = " << number_str2;
-				break;
-			}
-			case 0x3F: {
-				ss << "ACK FRAMING ERROR = " << number_str2;
-				break;
-			}
+	switch (LUOS_FRAME_KIND(frame.mType)) {
+		case HEADER_FRAME: {
+			for (U32 k = 0; k < HEADER_FIELDS; k++)
+				ExportField(out, time_str, LUOS_HEADER_LAYOUT[k].mLabel, LUOS_HEADER_LAYOUT[k].Extract(frame.mData1), display_base);
+			break;
+		}
+		case PAYLOAD_FRAME: {
+			U8 bytes[LUOS_PAYLOAD_MAX_BYTES];
+			U32 count = LuosPayloadBytes(frame, bytes);
+			U32 first = LuosPayloadIndex(frame);
+			for (U32 k = 0; k < count; k++)
+				ExportField(out, time_str, first + k, bytes[k], display_base);
+			break;
+		}
+		default: {
+			ExportField(out, time_str, frame.mData1, frame.mData2, display_base);
+			break;
 		}
 	}
-	else if (frame_data1 == 'MODE') {
-		switch (frame_data2) {
-			case 0: {
-				ss << "TARGET MODE = " << number_str2 << " ID";
-				break;
-			}
-			case 1: {
-				ss << "TARGET MODE = " << number_str2 << " IDACK";
-				break;
-			}
-			case 2: {
-				ss << "TARGET MODE = " << number_str2 << " TYPE";
-				break;
-			}
-			case 3: {
-				ss << "TARGET MODE = " << number_str2 << " BROADCAST";
-				break;
-			}
-			case 4: {
-				ss << "TARGET MODE = " << number_str2 << " MULTICAST";
-				break;
-			}
-			case 5: {
-				ss << "TARGET MODE = " << number_str2 << " NODEID";
-				break;
-			}
-			case 6: {
-				ss << "TARGET MODE = " << number_str2 << "  NODEIDACK";
-				break;
-			}
+}
+
+//the row of a stored msg: times, header fields, hex payload, crc and ack
+void ExportMessage( const LuosMessageStore& messages, U64 message_id, U64 trigger_sample, U32 sample_rate, DisplayBase display_base, std::string& out ) {
+	const U8* bytes;
+	LuosMessageInfo info;
+	U32 size = messages.GetMessage(message_id, &bytes, &info);
+	if (size < LUOS_HEADER_SIZE)
+		return;
+	U64 header = LuosReadHeader(bytes);
+	U64 mode = LUOS_HEADER_LAYOUT[HEADER_MODE].Extract(header);
+	U64 cmd = LUOS_HEADER_LAYOUT[HEADER_CMD].Extract(header);
+	char row_str[LUOS_TEXT_SIZE + 2 * LUOS_MAX_DATA_SIZE];
+	LuosText row(row_str, sizeof(row_str));
+
+	row.Time(info.mStartSample, trigger_sample, sample_rate) << ",";
+	row.Time(info.mEndSample, trigger_sample, sample_rate) << ",";
+	FieldValue('PROT', LUOS_HEADER_LAYOUT[HEADER_PROTOCOL].Extract(header), display_base, row) << ",";
+	FieldValue('TRGT', LUOS_HEADER_LAYOUT[HEADER_TARGET].Extract(header), display_base, row) << ",";
+	if (mode <= MODE_NODEIDACK)
+		row << LUOS_MODE_NAMES[mode] << ",";
+	else
+		row.Unsigned(mode) << ",";
+	FieldValue('SRC', LUOS_HEADER_LAYOUT[HEADER_SOURCE].Extract(header), display_base, row) << ",";
+	if (cmd < sizeof(LUOS_CMD_NAMES) / sizeof(LUOS_CMD_NAMES[0]))
+		row << LUOS_CMD_NAMES[cmd] << ",";
+	else
+		row.Unsigned(cmd) << ",";
+	row.Unsigned(LUOS_HEADER_LAYOUT[HEADER_SIZE].Extract(header)) << ",";
+	for (U32 k = LUOS_HEADER_SIZE; k < size; k++)
+		row.Hex(bytes[k]);
+	row << (info.mCrcGood ? ",OK," : ",NOT,");
+	if (info.mAcked) {
+		FieldValue('ACK', info.mAck, display_base, row) << ",";
+		row.Time(info.mAckSample, info.mEndSample, sample_rate);
+	}
+	else
+		row << ",";
+	row << "\n";
+	out.append(row_str, row.GetLength());
+}
+
+//function that translates the data to the desired display format - names come from the tables, values keep the display base
+void DataTranslation( U64 frame_data1, U64 frame_data2, DisplayBase display_base, LuosText& text ) {
+	switch (frame_data1) {
+		case 'ACK': {
+			U64 ack = frame_data2 >> 4;
+			if ((frame_data2 & 0x0F) == 0x0F && ack < sizeof(LUOS_ACK_NAMES) / sizeof(LUOS_ACK_NAMES[0]))
+				text << LUOS_ACK_NAMES[ack];
+			else
+				text << "ACK";
+			text << " = ";
+			FieldValue(frame_data1, frame_data2, display_base, text);
+			break;
+		}
+		case 'MODE': {
+			text << "TARGET MODE = ";
+			FieldValue(frame_data1, frame_data2, display_base, text);
+			if (frame_data2 <= MODE_NODEIDACK)
+				text << " " << LUOS_MODE_NAMES[frame_data2];
+			break;
+		}
+		case 'CMD': {
+			text << "CMD = ";
+			FieldValue(frame_data1, frame_data2, display_base, text);
+			if (frame_data2 < sizeof(LUOS_CMD_NAMES) / sizeof(LUOS_CMD_NAMES[0]))
+				text << " " << LUOS_CMD_NAMES[frame_data2];
+			break;
+		}
+		case 'NOT': {
+			text << "CRC = ";
+			FieldValue(frame_data1, frame_data2, display_base, text) << " - NOT GOOD";
+			break;
+		}
+		case 'CRC': {
+			text << "CRC = ";
+			FieldValue(frame_data1, frame_data2, display_base, text) << " - GOOD";
+			break;
+		}
+		case 'TRGT': {
+			text << "TARGET = ";
+			FieldValue(frame_data1, frame_data2, display_base, text);
+			break;
+		}
+		case 'SRC': {
+			text << "SOURCE = ";
+			FieldValue(frame_data1, frame_data2, display_base, text);
+			break;
+		}
+		case 'PROT': {
+			text << "PROTOCOL = ";
+			FieldValue(frame_data1, frame_data2, display_base, text);
+			break;
+		}
+		case 'SIZE': {
+			text << "SIZE = ";
+			FieldValue(frame_data1, frame_data2, display_base, text);
+			break;
+		}
+		default: {
+			text << "DATA[";
+			text.Number(frame_data1, Decimal, 8) << "] = ";
+			FieldValue(frame_data1, frame_data2, display_base, text);
+			break;
 		}
 	}
-	else if (frame_data1 == 'CMD') {
-		switch (frame_data2) {
-			case 0: {
-				ss << "CMD = " << number_str2 << " WRITE_NODE_ID";
-				break;
-			}
-			case 1: {
-				ss << "CMD = " << number_str2 << " RESET_DETECTION";
-				break;
-			}
-			case 2: {
-				ss << "CMD = " << number_str2 << " SET_BAUDRATE";
-				break;
-			}
-			case 3: {
-				ss << "CMD = " << number_str2 << " ASSERT";
-				break;
-			}
-			case 4: {
-				ss << "CMD = " << number_str2 << " RTB_CMD";
-				break;
-			}
-			case 5: {
-				ss << "CMD = " << number_str2 << " WRITE_ALIAS";
-				break;
-			}
-			case 6: {
-				ss << "CMD = " << number_str2 << " UPDATE_PUB";
-				break;
-			}
-			case 7: {
-				ss << "CMD = " << number_str2 << " NODE_UUID";
-				break;
-			}
-			case 8: {
-				ss << "CMD = " << number_str2 << " REVISION";
-				break;
-			}
-			case 9: {
-				ss << "CMD = " << number_str2 << " LUOS_REVISION";
-				break;
-			}
-			case 10: {
-				ss << "CMD = " << number_str2 << " LUOS_STATISTICS";
-				break;
-			}
-			case 11: {
-				ss << "CMD = " << number_str2 << " ASK_PUB_CMD";
-				break;
-			}
-			case 12: {
-				ss << "CMD = " << number_str2 << " COLOR";
-				break;
-			}
-			case 13: {
-				ss << "CMD = " << number_str2 << " COMPLIANT";
-				break;
-			}
-			case 14: {
-				ss << "CMD = " << number_str2 << " IO_STATE";
-				break;
-			}
-			case 15: {
-				ss << "CMD = " << number_str2 << " RATIO";
-				break;
-			}
-			case 16: {
-				ss << "CMD = " << number_str2 << " PEDOMETER";
-				break;
-			}
-			case 17: {
-				ss << "CMD = " << number_str2 << " ILLUMINANCE";
-				break;
-			}
-			case 18: {
-				ss << "CMD = " << number_str2 << " VOLTAGE";
-				break;
-			}
-			case 19: {
-				ss << "CMD = " << number_str2 << " CURRENT";
-				break;
-			}
-			case 20: {
-				ss << "CMD = " << number_str2 << " POWER";
-				break;
-			}
-			case 21: {
-				ss << "CMD = " << number_str2 << " TEMPERATURE";
-				break;
-			}
-			case 22: {
-				ss << "CMD = " << number_str2 << " TIME";
-				break;
-			}
-			case 23: {
-				ss << "CMD = " << number_str2 << " FORCE";
-				break;
-			}
-			case 24: {
-				ss << "CMD = " << number_str2 << " MOMENT";
-				break;
-			}
-			case 25: {
-				ss << "CMD = " << number_str2 << " CONTROL";
-				break;
-			}
-			case 26: {
-				ss << "CMD = " << number_str2 << " REGISTER";
-				break;
-			}
-			case 27: {
-				ss << "CMD = " << number_str2 << " REINIT";
-				break;
-			}
-			case 28: {
-				ss << "CMD = " << number_str2 << " PID";
-				break;
-			}
-			case 29: {
-				ss << "CMD = " << number_str2 << " RESOLUTION";
-				break;
-			}
-			case 30: {
-				ss << "CMD = " << number_str2 << " REDUCTION";
-				break;
-			}
-			case 31: {
-				ss << "CMD = " << number_str2 << " DIMENSION";
-				break;
-			}
-			case 32: {
-				ss << "CMD = " << number_str2 << " OFFSET";
-				break;
-			}
-			case 33: {
-				ss << "CMD = " << number_str2 << " SETID";
-				break;
-			}
-			case 34: {
-				ss << "CMD = " << number_str2 << " ANGULAR_POSITION";
-				break;
-			}
-			case 35: {
-				ss << "CMD = " << number_str2 << " ANGULAR_SPEED";
-				break;
-			}
-			case 36: {
-				ss << "CMD = " << number_str2 << " LINEAR_POSITION";
-				break;
-			}
-			case 37: {
-				ss << "CMD = " << number_str2 << " LINEAR_SPEED";
-				break;
-			}
-			case 38: {
-				ss << "CMD = " << number_str2 << " ACCEL_3D";
-				break;
-			}
-			case 39: {
-				ss << "CMD = " << number_str2 << " GYRO_3D";
-				break;
-			}
-			case 40: {
-				ss << "CMD = " << number_str2 << " QUATERNION";
-				break;
-			}
-			case 41: {
-				ss << "CMD = " << number_str2 << " COMPASS_3D";
-				break;
-			}
-			case 42: {
-				ss << "CMD = " << number_str2 << " EULER_3D";
-				break;
-			}
-			case 43: {
-				ss << "CMD = " << number_str2 << " ROT_MAT";
-				break;
-			}
-			case 44: {
-				ss << "CMD = " << number_str2 << " LINEAR_ACCEL";
-				break;
-			}
-			case 45: {
-				ss << "CMD = " << number_str2 << " GRAVITY_VECTOR";
-				break;
-			}
-			case 46: {
-				ss << "CMD = " << number_str2 << " HEADING";
-				break;
-			}
-			case 47: {
-				ss << "CMD = " << number_str2 << " ANGULAR_POSITION_LIMIT";
-				break;
-			}
-			case 48: {
-				ss << "CMD = " << number_str2 << " LINEAR_POSITION_LIMIT";
-				break;
-			}
-			case 49: {
-				ss << "CMD = " << number_str2 << " RATIO_LIMIT";
-				break;
-			}
-			case 50: {
-				ss << "CMD = " << number_str2 << " CURRENT_LIMIT";
-				break;
-			}
-			case 51: {
-				ss << "CMD = " << number_str2 << " ANGULAR_SPEED_LIMIT";
-				break;
-			}
-			case 52: {
-				ss << "CMD = " << number_str2 << " LINEAR_SPEED_LIMIT";
-				break;
-			}
-			case 53: {
-				ss << "CMD = " << number_str2 << " TORQUE_LIMIT";
-				break;
-			}
-			case 54: {
-				ss << "CMD = " << number_str2 << " DXL_WHEELMODE";
-				break;
-			}
-			case 55: {
-				ss << "CMD = " << number_str2 << " HANDY_SET_POSITION";
-				break;
-			}
-			case 56: {
-				ss << "CMD = " << number_str2 << " PARAMETERS";
+}
+
+//Function to gather what the tabular texts show of a msg - the header comes from the stored msg, the crc and the ack are the last frames of its packet
+void LuosAnalyzerResults::ReadPacket( U64 packet_id, LuosPacketSummary& summary )
+{
+	U64 first_frame_id, last_frame_id;
+	const U8* bytes;
+	GetFramesContainedInPacket( packet_id, &first_frame_id, &last_frame_id );
+
+	memset( &summary, 0, sizeof( summary ) );
+	summary.mStartSample = GetFrame( first_frame_id ).mStartingSampleInclusive;
+	if( mAnalyzer->GetMessageStore().GetMessage( packet_id, &bytes ) >= LUOS_HEADER_SIZE )
+	{
+		U64 header = LuosReadHeader( bytes );
+		summary.mSource = LUOS_HEADER_LAYOUT[ HEADER_SOURCE ].Extract( header );
+		summary.mTarget = LUOS_HEADER_LAYOUT[ HEADER_TARGET ].Extract( header );
+		summary.mMode = LUOS_HEADER_LAYOUT[ HEADER_MODE ].Extract( header );
+		summary.mCmd = LUOS_HEADER_LAYOUT[ HEADER_CMD ].Extract( header );
+		summary.mSize = LUOS_HEADER_LAYOUT[ HEADER_SIZE ].Extract( header );
+	}
+
+	for( U64 i = last_frame_id + 1; i-- > first_frame_id && last_frame_id - i < 2; )
+	{
+		Frame frame = GetFrame( i );
+		if( frame.mType != FIELD_FRAME )
+			continue;
+		switch( frame.mData1 ) {
+			case 'CRC':
+			case 'NOT': {
+				summary.mCrcGood = ( frame.mData1 == 'CRC' );
+				summary.mEndSample = frame.mEndingSampleInclusive;
 				break;
 			}
-			case 57: {
-				ss << "CMD = " << number_str2 << " LUOS_PROTOCOL_NB";
+			case 'ACK': {
+				summary.mAck = true;
+				summary.mAckData = frame.mData2;
+				summary.mAckSample = frame.mStartingSampleInclusive;
 				break;
 			}
 		}
 	}
-	else if (frame_data1 == 'NOT') {
-		ss << "CRC = " << number_str2 << " - NOT GOOD";
-	}
-	else if (frame_data1 == 'CRC') {
-		ss << "CRC = " << number_str2 << " - GOOD";
-	}
-	else if (frame_data1 == 'TRGT') {
-		ss << "TARGET = " << number_str2;
-	}
-	else if (frame_data1 == 'SRC') {
-		ss << "SOURCE = " << number_str2;
-	}
-	else if (frame_data1 == 'PROT') {
-	ss << "PROTOCOL = " << number_str2;
-	}
-	else if (frame_data1 == 'SIZE') {
-	ss << "SIZE = " << number_str2;
-	}
-	else {
-	ss << "DATA[" << frame_data1 << "] = " << number_str2;
-	}
-    return ss.str();
-	
 }
 
+/*Function to describe in ss the transfer starting with the packet packet_ids[ first ], read in summary, from the transfer stored by the analyzer.
+summary is left on its last fragment. Returns the index of the packet following it*/
+U64 LuosAnalyzerResults::ReadTransfer( const U64* packet_ids, U64 packet_count, U64 first, LuosPacketSummary& summary, std::stringstream& ss )
+{
+	LuosTransfer transfer;
+	if( summary.mSize <= LUOS_MAX_DATA_SIZE || !mAnalyzer->GetMessageStore().FindTransfer( packet_ids[ first ], transfer ) )
+		return first + 1;
+
+	U64 next = first + transfer.mFragments;
+	if( next > packet_count )
+		next = packet_count;
+	if( next - 1 != first )
+		ReadPacket( packet_ids[ next - 1 ], summary );
+
+	double seconds = double( transfer.mEndSample - transfer.mStartSample ) / mAnalyzer->GetSampleRate();
+	ss << ", TRANSFER = " << transfer.mReceived;
+	if( transfer.mReceived != transfer.mSize )
+		ss << " OF " << transfer.mSize;
+	ss << " BYTES IN " << transfer.mFragments << " MSGS, " << transfer.mReceived / seconds / 1000. << " kB/s";
+	if( !transfer.mComplete )
+		ss << ", INCOMPLETE";
+	return next;
+}
+
+//source -> target, command
+std::string LuosAnalyzerResults::RouteText( const LuosPacketSummary& summary, DisplayBase display_base )
+{
+	char source_str[128];
+	char target_str[128];
+	AnalyzerHelpers::GetNumberString( summary.mSource, display_base, 12, source_str, 128 );
+	AnalyzerHelpers::GetNumberString( summary.mTarget, display_base, 12, target_str, 128 );
+	char cmd_str[ LUOS_TEXT_SIZE ];
+	LuosText cmd_text( cmd_str, LUOS_TEXT_SIZE );
+	DataTranslation( 'CMD', summary.mCmd, display_base, cmd_text );
+	return std::string( source_str ) + " -> " + target_str + ", " + cmd_str;
+}
+
+//one line per msg: source -> target, command, size, crc and ack
 void LuosAnalyzerResults::GeneratePacketTabularText( U64 packet_id, DisplayBase display_base )
 {
-	//not supported
+#ifdef SUPPORTS_PROTOCOL_SEARCH
+	LuosPacketSummary summary;
+	std::stringstream ss;
 
+	ReadPacket( packet_id, summary );
+	ClearTabularText();
+	ss << RouteText( summary, display_base ) << ", SIZE = " << summary.mSize << ( summary.mCrcGood ? ", CRC GOOD" : ", CRC NOT GOOD" );
+	if( summary.mAck ) {
+		char ack_str[ LUOS_TEXT_SIZE ];
+		LuosText ack_text( ack_str, LUOS_TEXT_SIZE );
+		DataTranslation( 'ACK', summary.mAckData, display_base, ack_text );
+		ss << ", " << ack_str;
+	}
+	AddTabularText( ss.str().c_str() );
+#endif
 }
 
+//request and response: round trip time from the end of the request to the start of the ack or of the response msg
 void LuosAnalyzerResults::GenerateTransactionTabularText( U64 transaction_id, DisplayBase display_base )
 {
-	//not supported
+#ifdef SUPPORTS_PROTOCOL_SEARCH
+	U64* packet_ids;
+	U64 packet_count;
+	LuosPacketSummary request, response;
+	std::stringstream ss;
+	double us_per_sample = 1e6 / mAnalyzer->GetSampleRate();
+
+	GetPacketsContainedInTransaction( transaction_id, &packet_ids, &packet_count );
+	ClearTabularText();
+	if( packet_count == 0 )
+		return;
+	ReadPacket( packet_ids[ 0 ], request );
+	ss << RouteText( request, display_base ) << std::fixed << std::setprecision( 1 );
+	if( request.mAck )
+		ss << ", ACK RTT = " << ( request.mAckSample - request.mEndSample ) * us_per_sample << " us";
+	else if( request.mMode == MODE_IDACK || request.mMode == MODE_NODEIDACK )
+		ss << ", NO ACK";
+	//a request or a response sent in fragments is described once, from its last fragment
+	U64 response_id = ReadTransfer( packet_ids, packet_count, 0, request, ss );
+	if( response_id < packet_count ) {
+		ReadPacket( packet_ids[ response_id ], response );
+		ss << ", RESPONSE RTT = " << ( response.mStartSample - request.mEndSample ) * us_per_sample << " us";
+		if( ReadTransfer( packet_ids, packet_count, response_id, response, ss ) < packet_count )
+			ss << " (" << packet_count << " msgs)";
+	}
+	else if( request.mCmd == LUOS_ASK_PUB_CMD )
+		ss << ", NO RESPONSE";
+	AddTabularText( ss.str().c_str() );
+#endif
 }
@@ -2,12 +2,40 @@
 #define LUOS_ANALYZER_RESULTS
 
 #include <AnalyzerResults.h>
+#include "LuosBubbleCache.h"
+#include <functional>
 #include <sstream>
 #include <string>
 
 
+/*Frame::mType - the low nibble is the kind of frame:
+a field frame holds its label in mData1 and its value in mData2, a header frame holds the whole header in mData1,
+a payload frame holds up to 16 payload bytes in mData1 then mData2, first byte in the low byte. The index of its
+first byte / 8 is in the high nibble of mType and its byte count - 1 in the low bits of mFlags*/
+enum LuosFrameType { FIELD_FRAME, HEADER_FRAME, PAYLOAD_FRAME };
+
+#define LUOS_FRAME_KIND( type ) ( ( type ) & 0x0F )
+#define LUOS_PAYLOAD_MAX_BYTES 16
+#define LUOS_PAYLOAD_COUNT_MASK 0x0F
+
+inline U32 LuosPayloadIndex( const Frame& frame )
+{
+	return ( frame.mType >> 4 ) * 8;
+}
+
+//bytes of a payload frame, returns their count
+inline U32 LuosPayloadBytes( const Frame& frame, U8* bytes )
+{
+	U32 count = ( frame.mFlags & LUOS_PAYLOAD_COUNT_MASK ) + 1;
+	for( U32 i = 0; i < count; i++ )
+		bytes[ i ] = U8( ( i < 8 ? frame.mData1 : frame.mData2 ) >> ( 8 * ( i % 8 ) ) );
+	return count;
+}
+
 class LuosAnalyzer;
 class LuosAnalyzerSettings;
+class LuosExportFile;
+class LuosExportPool;
 
 class LuosAnalyzerResults : public AnalyzerResults
 {
@@ -23,10 +51,34 @@ public:
 	virtual void GenerateTransactionTabularText( U64 transaction_id, DisplayBase display_base );
 
 protected: //functions
+	//what the tabular texts show of a msg
+	struct LuosPacketSummary
+	{
+		U64 mSource, mTarget, mMode, mCmd, mSize;
+		bool mCrcGood;
+		bool mAck;
+		U64 mAckData;
+		U64 mStartSample;   //start of the first field
+		U64 mEndSample;     //end of the crc
+		U64 mAckSample;     //start of the ack
+	};
+
+	bool WriteChunks( LuosExportFile& export_file, LuosExportPool& pool, U64 count, const std::function< void( U32 slot, U64 chunk ) >& prepare );
+	void ExportFields( const char* file, DisplayBase display_base );
+	void ExportMessages( const char* file, DisplayBase display_base );
+	void ExportTransfers( const char* file, DisplayBase display_base );
+	void ExportSummary( const char* file );
+	void ExportBinary( const char* file );
+	void ExportPcapng( const char* file );
+
+	void ReadPacket( U64 packet_id, LuosPacketSummary& summary );
+	std::string RouteText( const LuosPacketSummary& summary, DisplayBase display_base );
+	U64 ReadTransfer( const U64* packet_ids, U64 packet_count, U64 first, LuosPacketSummary& summary, std::stringstream& ss );
 
 protected:  //vars
 	LuosAnalyzerSettings* mSettings;
 	LuosAnalyzer* mAnalyzer;
+	LuosBubbleCache mBubbleCache;
 };
 
 
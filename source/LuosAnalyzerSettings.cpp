@@ -1,11 +1,28 @@
 #include "LuosAnalyzerSettings.h"
 #include <AnalyzerHelpers.h>
 
+//a value loaded from a session is kept in the range of its interface
+static U32 ClampSetting( U32 value, U32 min, U32 max )
+{
+	if( value < min )
+		return min;
+	if( value > max )
+		return max;
+	return value;
+}
 
 LuosAnalyzerSettings::LuosAnalyzerSettings()
 :	mTxChannel( UNDEFINED_CHANNEL ),
 	mRxChannel( UNDEFINED_CHANNEL ),
-	mBitRate( 9600 )
+	mBitRate( 9600 ),
+	mAutoBaud( false ),
+	mSamplePoint( 50 ),
+	mGlitchFilter( 0 ),
+	mMajorityVote( false ),
+	mMarkerDensity( MARKERS_PER_BIT ),
+	mCompactHeader( false ),
+	mPayloadBytes( 1 ),
+	mUpdateRate( 20 )
 {
 
 	mTxChannelInterface.reset( new AnalyzerSettingInterfaceChannel() );
@@ -19,17 +36,83 @@ LuosAnalyzerSettings::LuosAnalyzerSettings()
 
 	mBitRateInterface.reset( new AnalyzerSettingInterfaceInteger() );
 	mBitRateInterface->SetTitleAndTooltip( "Bit Rate (Bits/S)",  "Specify the bit rate in bits per second." );
-	mBitRateInterface->SetMax( 6000000 );
-	mBitRateInterface->SetMin( 1 );
+	mBitRateInterface->SetMax( LUOS_MAX_BIT_RATE );
+	mBitRateInterface->SetMin( LUOS_MIN_BIT_RATE );
 	mBitRateInterface->SetInteger( mBitRate );
 
+	mAutoBaudInterface.reset( new AnalyzerSettingInterfaceBool() );
+	mAutoBaudInterface->SetTitleAndTooltip( "", "Measure the bit rate on the beginning of the capture and snap it to a standard rate. The bit rate field shows the detected rate." );
+	mAutoBaudInterface->SetCheckBoxText( "Detect the bit rate" );
+	mAutoBaudInterface->SetValue( mAutoBaud );
+
+	mSamplePointInterface.reset( new AnalyzerSettingInterfaceInteger() );
+	mSamplePointInterface->SetTitleAndTooltip( "Sample point (%)", "Where each bit is sampled, in percent of the bit from its beginning." );
+	mSamplePointInterface->SetMax( LUOS_MAX_SAMPLE_POINT );
+	mSamplePointInterface->SetMin( LUOS_MIN_SAMPLE_POINT );
+	mSamplePointInterface->SetInteger( mSamplePoint );
+
+	mGlitchFilterInterface.reset( new AnalyzerSettingInterfaceInteger() );
+	mGlitchFilterInterface->SetTitleAndTooltip( "Glitch filter (samples)", "Pulses shorter than this number of samples are ignored, the width in time follows the sample rate (3 samples are 125 ns at 24 MS/s). 0 disables the filter." );
+	mGlitchFilterInterface->SetMax( LUOS_MAX_GLITCH_FILTER );
+	mGlitchFilterInterface->SetMin( 0 );
+	mGlitchFilterInterface->SetInteger( mGlitchFilter );
+
+	mMajorityVoteInterface.reset( new AnalyzerSettingInterfaceBool() );
+	mMajorityVoteInterface->SetTitleAndTooltip( "", "Each bit is the level of 2 of 3 samples taken around its sample point." );
+	mMajorityVoteInterface->SetCheckBoxText( "Majority vote" );
+	mMajorityVoteInterface->SetValue( mMajorityVote );
+
+	mMarkerDensityInterface.reset( new AnalyzerSettingInterfaceNumberList() );
+	mMarkerDensityInterface->SetTitleAndTooltip( "Markers", "Fewer markers use less memory and decode faster on long captures." );
+	mMarkerDensityInterface->AddNumber( MARKERS_PER_BIT, "Every bit", "A marker on the sample point of every bit" );
+	mMarkerDensityInterface->AddNumber( MARKERS_PER_BYTE, "Start/stop of each byte", "A start and a stop marker per byte" );
+	mMarkerDensityInterface->AddNumber( MARKERS_ERRORS_ONLY, "Errors only", "Only framing, crc, timeout and collision errors" );
+	mMarkerDensityInterface->AddNumber( MARKERS_NONE, "None", "No markers" );
+	mMarkerDensityInterface->SetNumber( mMarkerDensity );
+
+	mCompactHeaderInterface.reset( new AnalyzerSettingInterfaceBool() );
+	mCompactHeaderInterface->SetTitleAndTooltip( "", "The whole header is shown as one frame instead of one frame per field, for 6 times fewer header frames." );
+	mCompactHeaderInterface->SetCheckBoxText( "One frame per header" );
+	mCompactHeaderInterface->SetValue( mCompactHeader );
+
+	mPayloadBytesInterface.reset( new AnalyzerSettingInterfaceNumberList() );
+	mPayloadBytesInterface->SetTitleAndTooltip( "Payload bytes per frame", "Packed payload bytes are shown as a hex and ascii run, for up to 16 times fewer frames." );
+	mPayloadBytesInterface->AddNumber( 1, "1", "One frame per data byte" );
+	mPayloadBytesInterface->AddNumber( 8, "8", "Up to 8 data bytes per frame" );
+	mPayloadBytesInterface->AddNumber( 16, "16", "Up to 16 data bytes per frame" );
+	mPayloadBytesInterface->SetNumber( mPayloadBytes );
+
+	mUpdateRateInterface.reset( new AnalyzerSettingInterfaceInteger() );
+	mUpdateRateInterface->SetTitleAndTooltip( "Updates per second", "How often the decoded messages and the progress are shown while decoding." );
+	mUpdateRateInterface->SetMax( LUOS_MAX_UPDATE_RATE );
+	mUpdateRateInterface->SetMin( LUOS_MIN_UPDATE_RATE );
+	mUpdateRateInterface->SetInteger( mUpdateRate );
+
 	AddInterface( mTxChannelInterface.get() );
 	AddInterface( mRxChannelInterface.get() );
 	AddInterface( mBitRateInterface.get() );
-
-	AddExportOption( 0, "Export as text/csv file" );
-	AddExportExtension( 0, "text", "txt" );
-	AddExportExtension( 0, "csv", "csv" );
+	AddInterface( mAutoBaudInterface.get() );
+	AddInterface( mSamplePointInterface.get() );
+	AddInterface( mGlitchFilterInterface.get() );
+	AddInterface( mMajorityVoteInterface.get() );
+	AddInterface( mMarkerDensityInterface.get() );
+	AddInterface( mCompactHeaderInterface.get() );
+	AddInterface( mPayloadBytesInterface.get() );
+	AddInterface( mUpdateRateInterface.get() );
+
+	AddExportOption( EXPORT_FIELDS, "Export as text/csv file" );
+	AddExportExtension( EXPORT_FIELDS, "text", "txt" );
+	AddExportExtension( EXPORT_FIELDS, "csv", "csv" );
+	AddExportOption( EXPORT_MESSAGES, "Export messages as csv file" );
+	AddExportExtension( EXPORT_MESSAGES, "csv", "csv" );
+	AddExportOption( EXPORT_BINARY, "Export messages as binary columns" );
+	AddExportExtension( EXPORT_BINARY, "Luos binary", "lbin" );
+	AddExportOption( EXPORT_PCAPNG, "Export messages as pcapng file (Wireshark)" );
+	AddExportExtension( EXPORT_PCAPNG, "pcapng", "pcapng" );
+	AddExportOption( EXPORT_TRANSFERS, "Export transfers as csv file" );
+	AddExportExtension( EXPORT_TRANSFERS, "csv", "csv" );
+	AddExportOption( EXPORT_SUMMARY, "Export capture summary as csv file" );
+	AddExportExtension( EXPORT_SUMMARY, "csv", "csv" );
 
 	ClearChannels();
 	AddChannel( mTxChannel, "Tx/One_wire", false );
@@ -47,6 +130,14 @@ bool LuosAnalyzerSettings::SetSettingsFromInterfaces()
 
 	//////////////add a comparison if the same input channels
 	mBitRate = mBitRateInterface->GetInteger();
+	mAutoBaud = mAutoBaudInterface->GetValue();
+	mSamplePoint = mSamplePointInterface->GetInteger();
+	mGlitchFilter = mGlitchFilterInterface->GetInteger();
+	mMajorityVote = mMajorityVoteInterface->GetValue();
+	mMarkerDensity = LuosMarkerDensity( U32( mMarkerDensityInterface->GetNumber() ) );
+	mCompactHeader = mCompactHeaderInterface->GetValue();
+	mPayloadBytes = U32( mPayloadBytesInterface->GetNumber() );
+	mUpdateRate = mUpdateRateInterface->GetInteger();
 
 	ClearChannels();
 	AddChannel( mTxChannel, "Tx/One_wire", true );
@@ -60,6 +151,14 @@ void LuosAnalyzerSettings::UpdateInterfacesFromSettings()
 	mTxChannelInterface->SetChannel( mTxChannel );
 	mRxChannelInterface->SetChannel( mRxChannel );
 	mBitRateInterface->SetInteger( mBitRate );
+	mAutoBaudInterface->SetValue( mAutoBaud );
+	mSamplePointInterface->SetInteger( mSamplePoint );
+	mGlitchFilterInterface->SetInteger( mGlitchFilter );
+	mMajorityVoteInterface->SetValue( mMajorityVote );
+	mMarkerDensityInterface->SetNumber( mMarkerDensity );
+	mCompactHeaderInterface->SetValue( mCompactHeader );
+	mPayloadBytesInterface->SetNumber( mPayloadBytes );
+	mUpdateRateInterface->SetInteger( mUpdateRate );
 }
 
 void LuosAnalyzerSettings::LoadSettings( const char* settings )
@@ -70,6 +169,28 @@ void LuosAnalyzerSettings::LoadSettings( const char* settings )
 	text_archive >> mTxChannel;
 	text_archive >> mRxChannel;
 	text_archive >> mBitRate;
+	mBitRate = ClampSetting( mBitRate, LUOS_MIN_BIT_RATE, LUOS_MAX_BIT_RATE );
+
+	//settings saved by older versions keep the default values of the newer settings,
+	//a hand edited or corrupt one only gets the values its interfaces accept: no zero update rate or payload bytes per frame
+	U32 marker_density, update_rate, sample_point, glitch_filter, payload_bytes;
+	bool auto_baud, majority_vote, compact_header;
+	if( text_archive >> marker_density )
+		mMarkerDensity = LuosMarkerDensity( ClampSetting( marker_density, MARKERS_PER_BIT, MARKERS_NONE ) );
+	if( text_archive >> update_rate )
+		mUpdateRate = ClampSetting( update_rate, LUOS_MIN_UPDATE_RATE, LUOS_MAX_UPDATE_RATE );
+	if( text_archive >> auto_baud )
+		mAutoBaud = auto_baud;
+	if( text_archive >> sample_point )
+		mSamplePoint = ClampSetting( sample_point, LUOS_MIN_SAMPLE_POINT, LUOS_MAX_SAMPLE_POINT );
+	if( text_archive >> glitch_filter )
+		mGlitchFilter = ClampSetting( glitch_filter, 0, LUOS_MAX_GLITCH_FILTER );
+	if( text_archive >> majority_vote )
+		mMajorityVote = majority_vote;
+	if( text_archive >> compact_header )
+		mCompactHeader = compact_header;
+	if( text_archive >> payload_bytes )
+		mPayloadBytes = ( payload_bytes == 8 || payload_bytes == 16 ) ? payload_bytes : 1;     //one of the list, or the default
 
 	ClearChannels();
 	AddChannel( mTxChannel, "Tx/One_wire", true );
@@ -86,6 +207,14 @@ const char* LuosAnalyzerSettings::SaveSettings()
 	text_archive << mTxChannel;
 	text_archive << mRxChannel;
 	text_archive << mBitRate;
+	text_archive << U32( mMarkerDensity );
+	text_archive << mUpdateRate;
+	text_archive << mAutoBaud;
+	text_archive << mSamplePoint;
+	text_archive << mGlitchFilter;
+	text_archive << mMajorityVote;
+	text_archive << mCompactHeader;
+	text_archive << mPayloadBytes;
 
 	return SetReturnString( text_archive.GetString() );
 }
@@ -4,6 +4,21 @@
 #include <AnalyzerSettings.h>
 #include <AnalyzerTypes.h>
 
+//ranges of the integer settings, the saved values are checked against them too
+#define LUOS_MIN_BIT_RATE 1
+#define LUOS_MAX_BIT_RATE 6000000
+#define LUOS_MIN_SAMPLE_POINT 10
+#define LUOS_MAX_SAMPLE_POINT 90
+#define LUOS_MAX_GLITCH_FILTER 1000000
+#define LUOS_MIN_UPDATE_RATE 1
+#define LUOS_MAX_UPDATE_RATE 1000
+
+//markers added by the decoder, from the most to the least
+enum LuosMarkerDensity { MARKERS_PER_BIT, MARKERS_PER_BYTE, MARKERS_ERRORS_ONLY, MARKERS_NONE };
+//export options: a row per field, a row per msg, the binary columns of LuosBinaryFormat.h, a pcapng file for Wireshark,
+//a row per transfer or the capture summary - each csv keeps a single set of columns
+enum LuosExportType { EXPORT_FIELDS, EXPORT_MESSAGES, EXPORT_BINARY, EXPORT_PCAPNG, EXPORT_TRANSFERS, EXPORT_SUMMARY };
+
 class LuosAnalyzerSettings : public AnalyzerSettings
 {
 public:
@@ -19,11 +34,27 @@ public:
 	Channel mTxChannel;
 
 	U32 mBitRate;
+	bool mAutoBaud;
+	U32 mSamplePoint;
+	U32 mGlitchFilter;
+	bool mMajorityVote;
+	LuosMarkerDensity mMarkerDensity;
+	bool mCompactHeader;
+	U32 mPayloadBytes;
+	U32 mUpdateRate;
 
 protected:
 	std::auto_ptr< AnalyzerSettingInterfaceChannel >	mRxChannelInterface;
 	std::auto_ptr< AnalyzerSettingInterfaceChannel >	mTxChannelInterface;
 	std::auto_ptr< AnalyzerSettingInterfaceInteger >	mBitRateInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceBool >		mAutoBaudInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceInteger >	mSamplePointInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceInteger >	mGlitchFilterInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceBool >		mMajorityVoteInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceNumberList >	mMarkerDensityInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceBool >		mCompactHeaderInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceNumberList >	mPayloadBytesInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceInteger >	mUpdateRateInterface;
 };
 
 #endif //LUOS_ANALYZER_SETTINGS
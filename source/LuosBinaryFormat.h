@@ -0,0 +1,185 @@
+#ifndef LUOS_BINARY_FORMAT
+#define LUOS_BINARY_FORMAT
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/*Binary export of the decoded msgs, columnar so tools can mmap it and use the columns as arrays without a copy.
+This header only needs the standard library: C++ tools include it as it is, Python tools map the same layout with numpy.
+
+Everything is little endian, every section starts on 8 bytes.
+	LuosBinaryFileHeader
+	row groups: the columns of up to LUOS_BINARY_GROUP_SIZE msgs, one after the other
+	LuosBinaryGroup table, one per row group
+	dictionary: uint64_t headers
+	LuosBinaryFooter, the last bytes of the file
+
+Columns of a row group, msg i of the group:
+	START           uint32_t    start sample - LuosBinaryGroup::mStartSample
+	DURATION        uint32_t    end of the crc - start, samples
+	HEADER          uint32_t    index in the dictionary
+	SIZE            uint16_t    SIZE field, bytes left to send of a fragmented msg
+	CRC             uint16_t    crc received
+	FLAGS           uint8_t     LUOS_BINARY_CRC_GOOD | LUOS_BINARY_ACKED
+	ACK             uint8_t     ack received
+	ACK_LATENCY     uint32_t    start of the ack - end of the crc, samples
+	PAYLOAD_OFFSET  uint32_t    count + 1 offsets in the payload heap, msg i is [offset[i], offset[i + 1])
+	PAYLOAD         uint8_t     payload heap
+A dictionary entry is the 7 header bytes of a msg read as a little endian uint64_t, SIZE field set to 0: the header of
+msg i is dictionary[HEADER[i]] | SIZE[i] << 40.
+
+Python, with data = numpy.memmap(file, dtype=numpy.uint8) and numpy dtypes mirroring LuosBinaryFooter and LuosBinaryGroup:
+	footer = data[-LUOS_BINARY_FOOTER_SIZE:].view(footer_dtype)
+	groups = data[footer.group_table_offset:][:footer.group_count * LUOS_BINARY_GROUP_HEADER_SIZE].view(group_dtype)
+	start = data[group.column_offset[START]:][:4 * group.message_count].view(numpy.uint32) + group.start_sample*/
+
+#define LUOS_BINARY_MAGIC "LUOSBIN"
+#define LUOS_BINARY_VERSION 1
+#define LUOS_BINARY_GROUP_SIZE 65536
+#define LUOS_BINARY_CRC_GOOD 0x01
+#define LUOS_BINARY_ACKED 0x02
+
+enum LuosBinaryColumn
+{
+	LUOS_BINARY_START,
+	LUOS_BINARY_DURATION,
+	LUOS_BINARY_HEADER,
+	LUOS_BINARY_SIZE,
+	LUOS_BINARY_CRC,
+	LUOS_BINARY_FLAGS,
+	LUOS_BINARY_ACK,
+	LUOS_BINARY_ACK_LATENCY,
+	LUOS_BINARY_PAYLOAD_OFFSET,
+	LUOS_BINARY_PAYLOAD,
+	LUOS_BINARY_COLUMNS
+};
+
+struct LuosBinaryFileHeader
+{
+	char mMagic[ 8 ];
+	uint32_t mVersion;
+	uint32_t mReserved;
+};
+
+struct LuosBinaryGroup
+{
+	uint64_t mFirstMessage;                             //index of its first msg in the file
+	uint64_t mStartSample;                              //base of the START column
+	uint32_t mMessageCount;
+	uint32_t mPayloadSize;                              //bytes in the payload heap
+	uint64_t mColumnOffset[ LUOS_BINARY_COLUMNS ];      //from the beginning of the file
+};
+
+struct LuosBinaryFooter
+{
+	uint64_t mMessageCount;
+	uint64_t mGroupCount;
+	uint64_t mGroupTableOffset;
+	uint64_t mDictionaryCount;
+	uint64_t mDictionaryOffset;
+	uint64_t mTriggerSample;
+	uint32_t mSampleRate;
+	uint32_t mVersion;
+	char mMagic[ 8 ];
+};
+
+#define LUOS_BINARY_GROUP_HEADER_SIZE 104
+#define LUOS_BINARY_FOOTER_SIZE 64
+static_assert( sizeof( LuosBinaryFileHeader ) == 16, "file header layout" );
+static_assert( sizeof( LuosBinaryGroup ) == LUOS_BINARY_GROUP_HEADER_SIZE, "row group layout" );
+static_assert( sizeof( LuosBinaryFooter ) == LUOS_BINARY_FOOTER_SIZE, "footer layout" );
+
+//bytes of an element of a column
+inline size_t LuosBinaryColumnWidth( LuosBinaryColumn column )
+{
+	static const uint8_t widths[ LUOS_BINARY_COLUMNS ] = { 4, 4, 4, 2, 2, 1, 1, 4, 4, 1 };
+	return widths[ column ];
+}
+
+/*Reads a mapped file in place, nothing is copied. The whole layout is checked when the file is opened: the groups, their columns,
+the payload offsets and the dictionary indexes are within the file, so a valid reader never reads past the mapping.
+The checks read the HEADER and PAYLOAD_OFFSET columns once*/
+class LuosBinaryReader
+{
+public:
+	LuosBinaryReader( const void* data, size_t size )
+	:	mData( static_cast< const uint8_t* >( data ) ),
+		mSize( size ),
+		mFooter( NULL )
+	{
+		if( size < sizeof( LuosBinaryFileHeader ) + sizeof( LuosBinaryFooter ) )
+			return;
+		const LuosBinaryFooter* footer = reinterpret_cast< const LuosBinaryFooter* >( mData + size - sizeof( LuosBinaryFooter ) );
+		uint64_t end = size - sizeof( LuosBinaryFooter );
+		if( memcmp( mData, LUOS_BINARY_MAGIC, 8 ) != 0 || memcmp( footer->mMagic, LUOS_BINARY_MAGIC, 8 ) != 0 ||
+			footer->mVersion != LUOS_BINARY_VERSION ||
+			!IsSection( footer->mGroupTableOffset, footer->mGroupCount, sizeof( LuosBinaryGroup ), sizeof( LuosBinaryFileHeader ), end ) ||
+			!IsSection( footer->mDictionaryOffset, footer->mDictionaryCount, sizeof( uint64_t ), sizeof( LuosBinaryFileHeader ), end ) )
+			return;
+
+		//the groups follow each other and hold every msg
+		const LuosBinaryGroup* groups = reinterpret_cast< const LuosBinaryGroup* >( mData + footer->mGroupTableOffset );
+		uint64_t messages = 0;
+		for( uint64_t i = 0; i < footer->mGroupCount; i++ )
+		{
+			if( groups[ i ].mFirstMessage != messages || !IsGroup( groups[ i ], footer->mGroupTableOffset, footer->mDictionaryCount ) )
+				return;
+			messages += groups[ i ].mMessageCount;
+		}
+		if( messages != footer->mMessageCount )
+			return;
+		mFooter = footer;
+	}
+
+	//false if the file is not a Luos binary export of this version, or if its layout is corrupt
+	bool IsValid() const { return mFooter != NULL; }
+	const LuosBinaryFooter& GetFooter() const { return *mFooter; }
+
+	uint64_t GetGroupCount() const { return mFooter->mGroupCount; }
+	const LuosBinaryGroup& GetGroup( uint64_t group ) const
+	{
+		return reinterpret_cast< const LuosBinaryGroup* >( mData + mFooter->mGroupTableOffset )[ group ];
+	}
+
+	template< class T > const T* GetColumn( const LuosBinaryGroup& group, LuosBinaryColumn column ) const
+	{
+		return reinterpret_cast< const T* >( mData + group.mColumnOffset[ column ] );
+	}
+
+	const uint64_t* GetDictionary() const { return reinterpret_cast< const uint64_t* >( mData + mFooter->mDictionaryOffset ); }
+
+protected:
+	//count elements of width bytes from offset, aligned on their width, in [begin, end) - without overflow whatever the values read
+	static bool IsSection( uint64_t offset, uint64_t count, uint64_t width, uint64_t begin, uint64_t end )
+	{
+		return offset >= begin && offset <= end && offset % ( width < 8 ? width : 8 ) == 0 && count <= ( end - offset ) / width;
+	}
+
+	//the columns of the group are before the group table, the payload offsets and the dictionary indexes are in range
+	bool IsGroup( const LuosBinaryGroup& group, uint64_t columns_end, uint64_t dictionary_count ) const
+	{
+		uint64_t count = group.mMessageCount;
+		if( count > LUOS_BINARY_GROUP_SIZE )
+			return false;
+		for( uint32_t column = 0; column < LUOS_BINARY_COLUMNS; column++ )
+		{
+			uint64_t elements = column == LUOS_BINARY_PAYLOAD_OFFSET ? count + 1 : column == LUOS_BINARY_PAYLOAD ? group.mPayloadSize : count;
+			if( !IsSection( group.mColumnOffset[ column ], elements, LuosBinaryColumnWidth( LuosBinaryColumn( column ) ), sizeof( LuosBinaryFileHeader ), columns_end ) )
+				return false;
+		}
+
+		const uint32_t* headers = GetColumn< uint32_t >( group, LUOS_BINARY_HEADER );
+		const uint32_t* payload_offsets = GetColumn< uint32_t >( group, LUOS_BINARY_PAYLOAD_OFFSET );
+		for( uint64_t i = 0; i < count; i++ )
+			if( headers[ i ] >= dictionary_count || payload_offsets[ i ] > payload_offsets[ i + 1 ] )
+				return false;
+		return payload_offsets[ count ] <= group.mPayloadSize;
+	}
+
+	const uint8_t* mData;
+	size_t mSize;
+	const LuosBinaryFooter* mFooter;
+};
+
+#endif //LUOS_BINARY_FORMAT
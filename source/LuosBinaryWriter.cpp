@@ -0,0 +1,167 @@
+#include "LuosBinaryWriter.h"
+#include "LuosHeader.h"
+#include <string.h>
+
+//SIZE field of a header, kept in its own column
+#define LUOS_BINARY_SIZE_MASK ( 0xFFFFull << 40 )
+#define LUOS_BINARY_NO_ACK 0xFFFFFFFF
+//initial slots of the dictionary table, a power of 2
+#define LUOS_BINARY_TABLE_SIZE 1024
+
+LuosBinaryWriter::LuosBinaryWriter( const char* file_name, U64 trigger_sample, U32 sample_rate )
+:	mFile( file_name, true ),
+	mTriggerSample( trigger_sample ),
+	mSampleRate( sample_rate ),
+	mMessageCount( 0 )
+{
+	memset( &mGroup, 0, sizeof( mGroup ) );
+	mStart.reserve( LUOS_BINARY_GROUP_SIZE );
+	mDuration.reserve( LUOS_BINARY_GROUP_SIZE );
+	mHeader.reserve( LUOS_BINARY_GROUP_SIZE );
+	mSize.reserve( LUOS_BINARY_GROUP_SIZE );
+	mCrc.reserve( LUOS_BINARY_GROUP_SIZE );
+	mFlags.reserve( LUOS_BINARY_GROUP_SIZE );
+	mAck.reserve( LUOS_BINARY_GROUP_SIZE );
+	mAckLatency.reserve( LUOS_BINARY_GROUP_SIZE );
+	mPayloadOffset.reserve( LUOS_BINARY_GROUP_SIZE + 1 );
+	mPayloadOffset.push_back( 0 );
+	mDictionaryTable.resize( LUOS_BINARY_TABLE_SIZE, 0 );
+
+	LuosBinaryFileHeader header;
+	memset( &header, 0, sizeof( header ) );
+	memcpy( header.mMagic, LUOS_BINARY_MAGIC, sizeof( LUOS_BINARY_MAGIC ) );
+	header.mVersion = LUOS_BINARY_VERSION;
+	mFile.Write( &header, sizeof( header ) );
+}
+
+LuosBinaryWriter::~LuosBinaryWriter()
+{
+}
+
+void LuosBinaryWriter::AddMessage( const U8* bytes, U32 size, const LuosMessageInfo& info )
+{
+	//a new group when it is full or when the start does not fit 32 bits from its base
+	if( mGroup.mMessageCount == LUOS_BINARY_GROUP_SIZE ||
+		( mGroup.mMessageCount != 0 && ( info.mStartSample < mGroup.mStartSample || info.mStartSample - mGroup.mStartSample > 0xFFFFFFFF ) ) )
+		WriteGroup();
+	if( mGroup.mMessageCount == 0 )
+	{
+		mGroup.mFirstMessage = mMessageCount;
+		mGroup.mStartSample = info.mStartSample;
+	}
+
+	U64 header = LuosReadHeader( bytes );
+
+	mStart.push_back( U32( info.mStartSample - mGroup.mStartSample ) );
+	mDuration.push_back( U32( info.mEndSample > info.mStartSample ? info.mEndSample - info.mStartSample : 0 ) );
+	mHeader.push_back( DictionaryIndex( header & ~LUOS_BINARY_SIZE_MASK ) );
+	mSize.push_back( U16( LUOS_HEADER_LAYOUT[ HEADER_SIZE ].Extract( header ) ) );
+	mCrc.push_back( info.mCrc );
+	mFlags.push_back( U8( ( info.mCrcGood ? LUOS_BINARY_CRC_GOOD : 0 ) | ( info.mAcked ? LUOS_BINARY_ACKED : 0 ) ) );
+	mAck.push_back( info.mAck );
+	mAckLatency.push_back( info.mAcked && info.mAckSample > info.mEndSample ? U32( info.mAckSample - info.mEndSample ) : info.mAcked ? 0 : LUOS_BINARY_NO_ACK );
+	mPayload.insert( mPayload.end(), bytes + LUOS_HEADER_SIZE, bytes + size );
+	mPayloadOffset.push_back( U32( mPayload.size() ) );
+
+	mGroup.mMessageCount++;
+	mMessageCount++;
+}
+
+void LuosBinaryWriter::Close()
+{
+	if( mGroup.mMessageCount != 0 )
+		WriteGroup();
+
+	LuosBinaryFooter footer;
+	memset( &footer, 0, sizeof( footer ) );
+	footer.mMessageCount = mMessageCount;
+	footer.mGroupCount = mGroups.size();
+	footer.mGroupTableOffset = mFile.GetOffset();
+	if( !mGroups.empty() )
+		mFile.Write( &mGroups[ 0 ], U32( mGroups.size() * sizeof( LuosBinaryGroup ) ) );
+	footer.mDictionaryCount = mDictionary.size();
+	footer.mDictionaryOffset = mFile.GetOffset();
+	if( !mDictionary.empty() )
+		mFile.Write( &mDictionary[ 0 ], U32( mDictionary.size() * sizeof( U64 ) ) );
+	footer.mTriggerSample = mTriggerSample;
+	footer.mSampleRate = mSampleRate;
+	footer.mVersion = LUOS_BINARY_VERSION;
+	memcpy( footer.mMagic, LUOS_BINARY_MAGIC, sizeof( LUOS_BINARY_MAGIC ) );
+	mFile.Write( &footer, sizeof( footer ) );
+}
+
+void LuosBinaryWriter::WriteGroup()
+{
+	U32 count = mGroup.mMessageCount;
+	mGroup.mPayloadSize = U32( mPayload.size() );
+	WriteColumn( LUOS_BINARY_START, &mStart[ 0 ], count * sizeof( U32 ) );
+	WriteColumn( LUOS_BINARY_DURATION, &mDuration[ 0 ], count * sizeof( U32 ) );
+	WriteColumn( LUOS_BINARY_HEADER, &mHeader[ 0 ], count * sizeof( U32 ) );
+	WriteColumn( LUOS_BINARY_SIZE, &mSize[ 0 ], count * sizeof( U16 ) );
+	WriteColumn( LUOS_BINARY_CRC, &mCrc[ 0 ], count * sizeof( U16 ) );
+	WriteColumn( LUOS_BINARY_FLAGS, &mFlags[ 0 ], count * sizeof( U8 ) );
+	WriteColumn( LUOS_BINARY_ACK, &mAck[ 0 ], count * sizeof( U8 ) );
+	WriteColumn( LUOS_BINARY_ACK_LATENCY, &mAckLatency[ 0 ], count * sizeof( U32 ) );
+	WriteColumn( LUOS_BINARY_PAYLOAD_OFFSET, &mPayloadOffset[ 0 ], ( count + 1 ) * sizeof( U32 ) );
+	WriteColumn( LUOS_BINARY_PAYLOAD, mPayload.data(), mPayload.size() );
+	mGroups.push_back( mGroup );
+
+	//the next group reuses the memory
+	memset( &mGroup, 0, sizeof( mGroup ) );
+	mStart.clear();
+	mDuration.clear();
+	mHeader.clear();
+	mSize.clear();
+	mCrc.clear();
+	mFlags.clear();
+	mAck.clear();
+	mAckLatency.clear();
+	mPayloadOffset.resize( 1 );
+	mPayload.clear();
+}
+
+//a column starts on 8 bytes, the padding is 0
+void LuosBinaryWriter::WriteColumn( LuosBinaryColumn column, const void* data, U64 size )
+{
+	static const U8 padding[ 8 ] = { 0 };
+	mGroup.mColumnOffset[ column ] = mFile.GetOffset();
+	if( size != 0 )
+		mFile.Write( data, U32( size ) );
+	if( size % 8 != 0 )
+		mFile.Write( padding, U32( 8 - size % 8 ) );
+}
+
+//index of a header in the dictionary, added if it is new
+U32 LuosBinaryWriter::DictionaryIndex( U64 key )
+{
+	U32 mask = U32( mDictionaryTable.size() - 1 );
+	U32 slot = Home( key ) & mask;
+	while( mDictionaryTable[ slot ] != 0 )
+	{
+		if( mDictionary[ mDictionaryTable[ slot ] - 1 ] == key )
+			return mDictionaryTable[ slot ] - 1;
+		slot = ( slot + 1 ) & mask;
+	}
+
+	mDictionary.push_back( key );
+	mDictionaryTable[ slot ] = U32( mDictionary.size() );
+
+	//at most half full: the table doubles and the headers are added again
+	if( 2 * mDictionary.size() > mDictionaryTable.size() )
+	{
+		mDictionaryTable.assign( 2 * mDictionaryTable.size(), 0 );
+		mask = U32( mDictionaryTable.size() - 1 );
+		for( U32 i = 0; i < mDictionary.size(); i++ )
+		{
+			for( slot = Home( mDictionary[ i ] ) & mask; mDictionaryTable[ slot ] != 0; slot = ( slot + 1 ) & mask )
+				;
+			mDictionaryTable[ slot ] = i + 1;
+		}
+	}
+	return U32( mDictionary.size() - 1 );
+}
+
+U32 LuosBinaryWriter::Home( U64 key ) const
+{
+	return U32( ( key * 0x9E3779B97F4A7C15ull ) >> 32 );
+}
@@ -0,0 +1,51 @@
+#ifndef LUOS_BINARY_WRITER
+#define LUOS_BINARY_WRITER
+
+#include "LuosBinaryFormat.h"
+#include "LuosExportFile.h"
+#include "LuosMessageStore.h"
+#include <vector>
+
+/*Writes the msgs in the LuosBinaryFormat.h layout: the columns of a row group are kept in memory
+until the group is full, then written one after the other. The file is only appended to,
+the group table, the dictionary and the footer are written by Close after the last group.
+A file that is not closed has no footer and is rejected by LuosBinaryReader*/
+class LuosBinaryWriter
+{
+public:
+	LuosBinaryWriter( const char* file_name, U64 trigger_sample, U32 sample_rate );
+	~LuosBinaryWriter();
+
+	void AddMessage( const U8* bytes, U32 size, const LuosMessageInfo& info );
+	void Close();
+
+protected:
+	void WriteGroup();
+	void WriteColumn( LuosBinaryColumn column, const void* data, U64 size );
+	U32 DictionaryIndex( U64 key );
+	U32 Home( U64 key ) const;
+
+	LuosExportFile mFile;
+	U64 mTriggerSample;
+	U32 mSampleRate;
+	U64 mMessageCount;
+
+	//row group being filled
+	LuosBinaryGroup mGroup;
+	std::vector< U32 > mStart;
+	std::vector< U32 > mDuration;
+	std::vector< U32 > mHeader;
+	std::vector< U16 > mSize;
+	std::vector< U16 > mCrc;
+	std::vector< U8 > mFlags;
+	std::vector< U8 > mAck;
+	std::vector< U32 > mAckLatency;
+	std::vector< U32 > mPayloadOffset;
+	std::vector< U8 > mPayload;
+
+	std::vector< LuosBinaryGroup > mGroups;
+	std::vector< U64 > mDictionary;
+	std::vector< U32 > mDictionaryTable;    //open addressing: dictionary index + 1, 0: empty slot
+};
+
+#endif //LUOS_BINARY_WRITER
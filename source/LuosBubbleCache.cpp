@@ -0,0 +1,128 @@
+#include "LuosBubbleCache.h"
+#include <string.h>
+
+//twice the entries: the probe sequences stay short
+#define LUOS_BUBBLE_TABLE_SIZE ( 2 * LUOS_BUBBLE_CACHE_SIZE )
+#define LUOS_BUBBLE_TABLE_MASK ( LUOS_BUBBLE_TABLE_SIZE - 1 )
+#define LUOS_NO_ENTRY 0xFFFFFFFF
+
+LuosBubbleCache::LuosBubbleCache()
+:	mEntries( new Entry[ LUOS_BUBBLE_CACHE_SIZE ] ),
+	mTable( new U32[ LUOS_BUBBLE_TABLE_SIZE ] )
+{
+	Clear();
+}
+
+LuosBubbleCache::~LuosBubbleCache()
+{
+}
+
+void LuosBubbleCache::Clear()
+{
+	std::lock_guard< std::mutex > lock( mMutex );
+	mUsed = 0;
+	mHead = LUOS_NO_ENTRY;
+	mTail = LUOS_NO_ENTRY;
+	memset( mTable.get(), 0, LUOS_BUBBLE_TABLE_SIZE * sizeof( U32 ) );
+}
+
+U32 LuosBubbleCache::Find( U64 frame_index, DisplayBase display_base, char* text )
+{
+	std::lock_guard< std::mutex > lock( mMutex );
+	U32 slot = Lookup( Key( frame_index, display_base ) );
+	if( mTable[ slot ] == 0 )
+		return 0;
+
+	U32 entry = mTable[ slot ] - 1;
+	if( entry != mHead )
+	{
+		Unlink( entry );
+		PushFront( entry );
+	}
+	memcpy( text, mEntries[ entry ].mText, mEntries[ entry ].mSize );
+	return mEntries[ entry ].mSize;
+}
+
+void LuosBubbleCache::Add( U64 frame_index, DisplayBase display_base, const char* text, U32 size )
+{
+	std::lock_guard< std::mutex > lock( mMutex );
+	U64 key = Key( frame_index, display_base );
+	U32 slot = Lookup( key );
+	if( mTable[ slot ] != 0 )   //added by another call meanwhile
+		return;
+
+	U32 entry;
+	if( mUsed < LUOS_BUBBLE_CACHE_SIZE )
+	{
+		entry = mUsed++;
+	}
+	else
+	{
+		//the least recently used bubble is replaced
+		entry = mTail;
+		Unlink( entry );
+		RemoveSlot( Lookup( mEntries[ entry ].mKey ) );
+		slot = Lookup( key );
+	}
+
+	mEntries[ entry ].mKey = key;
+	mEntries[ entry ].mSize = size;
+	memcpy( mEntries[ entry ].mText, text, size );
+	mTable[ slot ] = entry + 1;
+	PushFront( entry );
+}
+
+U32 LuosBubbleCache::Home( U64 key ) const
+{
+	return U32( ( key * 0x9E3779B97F4A7C15ull ) >> 40 ) & LUOS_BUBBLE_TABLE_MASK;
+}
+
+//slot of the key, or the empty slot where it would be added
+U32 LuosBubbleCache::Lookup( U64 key ) const
+{
+	U32 slot = Home( key );
+	while( mTable[ slot ] != 0 && mEntries[ mTable[ slot ] - 1 ].mKey != key )
+		slot = ( slot + 1 ) & LUOS_BUBBLE_TABLE_MASK;
+	return slot;
+}
+
+//the next entries of the probe sequence are shifted back into the hole, no tombstone is left
+void LuosBubbleCache::RemoveSlot( U32 slot )
+{
+	U32 hole = slot;
+	for( U32 i = ( slot + 1 ) & LUOS_BUBBLE_TABLE_MASK; mTable[ i ] != 0; i = ( i + 1 ) & LUOS_BUBBLE_TABLE_MASK )
+	{
+		U32 home = Home( mEntries[ mTable[ i ] - 1 ].mKey );
+		if( ( ( i - home ) & LUOS_BUBBLE_TABLE_MASK ) >= ( ( i - hole ) & LUOS_BUBBLE_TABLE_MASK ) )
+		{
+			mTable[ hole ] = mTable[ i ];
+			hole = i;
+		}
+	}
+	mTable[ hole ] = 0;
+}
+
+void LuosBubbleCache::Unlink( U32 entry )
+{
+	Entry& e = mEntries[ entry ];
+	if( e.mPrev != LUOS_NO_ENTRY )
+		mEntries[ e.mPrev ].mNext = e.mNext;
+	else
+		mHead = e.mNext;
+	if( e.mNext != LUOS_NO_ENTRY )
+		mEntries[ e.mNext ].mPrev = e.mPrev;
+	else
+		mTail = e.mPrev;
+}
+
+void LuosBubbleCache::PushFront( U32 entry )
+{
+	Entry& e = mEntries[ entry ];
+	e.mPrev = LUOS_NO_ENTRY;
+	e.mNext = mHead;
+	if( mHead != LUOS_NO_ENTRY )
+		mEntries[ mHead ].mPrev = entry;
+	else
+		mTail = entry;
+	mHead = entry;
+}
@@ -0,0 +1,55 @@
+#ifndef LUOS_BUBBLE_CACHE
+#define LUOS_BUBBLE_CACHE
+
+#include <LogicPublicTypes.h>
+#include <memory>
+#include <mutex>
+
+//bubble and tabular text size, all the strings of a bubble
+#define LUOS_TEXT_SIZE 512
+//bubbles kept, a power of 2
+#define LUOS_BUBBLE_CACHE_SIZE 4096
+
+/*Bubble texts of the last frames shown, by frame index and display base.
+Logic asks again for the bubbles of the same frames on every pan and zoom: a cached bubble skips GetFrame and the formatting.
+The least recently used bubble is replaced when the cache is full. The entries and the hash table are allocated once,
+a lookup or an add does not allocate. Frames never change once added: a bubble stays valid until the results are destroyed.
+The ui thread calls it while the worker thread adds frames, every call holds the mutex*/
+class LuosBubbleCache
+{
+public:
+	LuosBubbleCache();
+	~LuosBubbleCache();
+
+	void Clear();
+	//a bubble is the strings of decreasing zoom, one after the other with their ends
+	//copies the cached bubble in text (LUOS_TEXT_SIZE bytes), returns its size, 0 if it is not cached
+	U32 Find( U64 frame_index, DisplayBase display_base, char* text );
+	void Add( U64 frame_index, DisplayBase display_base, const char* text, U32 size );
+
+protected:
+	struct Entry
+	{
+		U64 mKey;
+		U32 mPrev;          //more recently used entry
+		U32 mNext;          //less recently used entry
+		U32 mSize;
+		char mText[ LUOS_TEXT_SIZE ];
+	};
+
+	static U64 Key( U64 frame_index, DisplayBase display_base ) { return ( frame_index << 3 ) | U64( display_base ); }
+	U32 Home( U64 key ) const;
+	U32 Lookup( U64 key ) const;
+	void RemoveSlot( U32 slot );
+	void Unlink( U32 entry );
+	void PushFront( U32 entry );
+
+	std::unique_ptr< Entry[] > mEntries;
+	U32 mUsed;                          //entries used, they are only recycled once all are used
+	U32 mHead;                          //most recently used entry
+	U32 mTail;                          //least recently used entry
+	std::unique_ptr< U32[] > mTable;    //open addressing: entry index + 1, 0: empty slot
+	std::mutex mMutex;
+};
+
+#endif //LUOS_BUBBLE_CACHE
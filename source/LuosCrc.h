@@ -0,0 +1,69 @@
+#ifndef LUOS_CRC
+#define LUOS_CRC
+
+#include <LogicPublicTypes.h>
+
+//Luos crc16: polynomial 0x0007, initial value 0xFFFF, msb first
+#define LUOS_CRC_POLYNOMIAL 0x0007
+#define LUOS_CRC_INIT 0xFFFF
+#define LUOS_CRC_SLICES 4
+
+//table entries are generated at compile time
+//entry [k][i]: crc register after the byte i followed by k null bytes, starting from 0
+constexpr U16 LuosCrcShift( U16 crc, U32 bits )
+{
+	return bits == 0 ? crc : LuosCrcShift( ( crc & 0x8000 ) ? U16( ( crc << 1 ) ^ LUOS_CRC_POLYNOMIAL ) : U16( crc << 1 ), bits - 1 );
+}
+
+constexpr U16 LuosCrcEntry( U32 slice, U32 byte )
+{
+	return slice == 0 ? LuosCrcShift( U16( byte << 8 ), 8 )
+					  : U16( ( LuosCrcEntry( slice - 1, byte ) << 8 ) ^ LuosCrcEntry( 0, LuosCrcEntry( slice - 1, byte ) >> 8 ) );
+}
+
+template< U32... I > struct LuosCrcTable
+{
+	static constexpr U16 mEntries[ LUOS_CRC_SLICES ][ sizeof...( I ) ] = {
+		{ LuosCrcEntry( 0, I )... }, { LuosCrcEntry( 1, I )... }, { LuosCrcEntry( 2, I )... }, { LuosCrcEntry( 3, I )... } };
+};
+template< U32... I > constexpr U16 LuosCrcTable< I... >::mEntries[ LUOS_CRC_SLICES ][ sizeof...( I ) ];
+
+//LuosCrcTableBuilder< 256 >::Table is LuosCrcTable< 0, 1, ..., 255 >
+template< U32 N, U32... I > struct LuosCrcTableBuilder : LuosCrcTableBuilder< N - 1, N - 1, I... > {};
+template< U32... I > struct LuosCrcTableBuilder< 0, I... >
+{
+	typedef LuosCrcTable< I... > Table;
+};
+
+class LuosCrc
+{
+public:
+	LuosCrc() : mCrc( LUOS_CRC_INIT ) {}
+
+	void Reset() { mCrc = LUOS_CRC_INIT; }
+	U16 GetCrc() const { return mCrc; }
+
+	//one byte, as it is received
+	void Update( U8 data )
+	{
+		mCrc = U16( ( mCrc << 8 ) ^ Table::mEntries[ 0 ][ ( mCrc >> 8 ) ^ data ] );
+	}
+
+	//whole buffer, LUOS_CRC_SLICES bytes per table lookup round
+	void Update( const U8* data, U32 length )
+	{
+		for( ; length >= LUOS_CRC_SLICES; data += LUOS_CRC_SLICES, length -= LUOS_CRC_SLICES )
+		{
+			mCrc = U16( Table::mEntries[ 3 ][ data[ 0 ] ^ ( mCrc >> 8 ) ] ^ Table::mEntries[ 2 ][ data[ 1 ] ^ ( mCrc & 0xFF ) ] ^
+						Table::mEntries[ 1 ][ data[ 2 ] ] ^ Table::mEntries[ 0 ][ data[ 3 ] ] );
+		}
+		for( ; length > 0; data++, length-- )
+			Update( *data );
+	}
+
+protected:
+	typedef LuosCrcTableBuilder< 256 >::Table Table;
+	U16 mCrc;
+};
+
+#endif //LUOS_CRC
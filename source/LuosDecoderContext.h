@@ -0,0 +1,88 @@
+#ifndef LUOS_DECODER_CONTEXT
+#define LUOS_DECODER_CONTEXT
+
+#include <LogicPublicTypes.h>
+#include <string.h>
+#include "LuosCrc.h"
+#include "LuosHeader.h"
+#include "LuosMessageStore.h"
+
+#define LUOS_MAX_DATA_SIZE 128
+
+typedef enum { HEADER,
+							 DATA,
+						 	 CRC,
+						   ACK,
+						 	 WAIT }pos_state;
+
+//Everything the decoder changes while it runs. Each analyzer owns one context and only its WorkerThread uses it,
+//so several Luos analyzers can decode at the same time without sharing anything.
+class LuosDecoderContext
+{
+public:
+	LuosDecoderContext() { Reset( true ); }
+
+	//beginning of a WorkerThread run
+	void Reset( bool one_wire )
+	{
+		mOneWire = one_wire;
+		mState = WAIT;      //look for the first message
+		StartMessage();
+		mDataByte = 0;
+		mFirstByte = 0;
+		mByteStart = 0;
+		mFieldStart = 0;
+		mSize = 0;
+		mTarget = 0;
+		mSource = 0;
+		mRxMsg = 0;
+		mCollisionDetection = 0;
+		mTracking = 0;
+		memset( mRequest, 0, sizeof( mRequest ) );
+		memset( mRequestEnd, 0, sizeof( mRequestEnd ) );
+		memset( mTransfers, 0, sizeof( mTransfers ) );
+		memset( mTransferIds, 0, sizeof( mTransferIds ) );
+	}
+
+	//beginning of a new msg
+	void StartMessage()
+	{
+		mMessageSize = 0;
+		mHeader = 0;
+		mDataIdx = 0;
+		mAck = 0;
+		memset( &mInfo, 0, sizeof( mInfo ) );
+	}
+
+	bool mOneWire;              //no Rx channel: msgs and acks on the same line
+	U32 mState;                 //state machine position in the msg
+
+	U8 mMessage[ LUOS_HEADER_SIZE + LUOS_MAX_DATA_SIZE ];    //received bytes, the crc is computed on them
+	U16 mMessageSize;
+	LuosCrc mCrc;
+
+	LuosMessageInfo mInfo;      //stored with the bytes at the end of the msg
+
+	U64 mHeader;                            //header bytes received so far, little endian
+	U64 mHeaderStart[ LUOS_HEADER_SIZE ];   //falling edge of the start bit of each header byte
+
+	U8 mDataByte;               //last decoded character
+	U8 mFirstByte;              //first character of a field spread over two characters
+	U64 mByteStart;             //falling edge of the start bit of mDataByte
+	U64 mFieldStart;            //falling edge of the start bit of mFirstByte
+
+	U16 mSize, mDataIdx, mTarget, mSource;
+	U64 mPayloadStart;          //first and last sample of the payload bytes not sent in a frame yet
+	U64 mPayloadEnd;
+	bool mAck;                  //the msg waits for an ack
+	bool mRxMsg;                //Tx/Rx config: the msg is read from Rx
+	bool mCollisionDetection;   //Tx/Rx config: Tx and Rx carry different data
+	U64 mTracking;              //keeps the start and the end of ack timeout period
+
+	U64 mRequest[ LUOS_ID_COUNT ];          //by node id: transaction id + 1 of the request waiting for a response from it, 0: none
+	U64 mRequestEnd[ LUOS_ID_COUNT ];       //by node id: end of the crc of this request
+	LuosTransfer mTransfers[ LUOS_ID_COUNT ];   //by source id: transfer in flight, a node sends one msg at a time
+	U64 mTransferIds[ LUOS_ID_COUNT ];          //by source id: store id of the transfer in flight
+};
+
+#endif //LUOS_DECODER_CONTEXT
@@ -0,0 +1,42 @@
+#include "LuosExportFile.h"
+#include <AnalyzerHelpers.h>
+#include <string.h>
+
+LuosExportFile::LuosExportFile( const char* file_name, bool is_binary )
+:	mFile( AnalyzerHelpers::StartFile( file_name, is_binary ) ),
+	mBuffer( new U8[ LUOS_EXPORT_BUFFER_SIZE ] ),
+	mUsed( 0 ),
+	mOffset( 0 )
+{
+}
+
+LuosExportFile::~LuosExportFile()
+{
+	Flush();
+	AnalyzerHelpers::EndFile( mFile );
+}
+
+void LuosExportFile::Write( const void* data, U32 size )
+{
+	mOffset += size;
+	if( mUsed + size > LUOS_EXPORT_BUFFER_SIZE )
+		Flush();
+
+	//larger than the buffer: written as it is
+	if( size >= LUOS_EXPORT_BUFFER_SIZE )
+	{
+		AnalyzerHelpers::AppendToFile( ( const U8* )data, size, mFile );
+		return;
+	}
+
+	memcpy( mBuffer.get() + mUsed, data, size );
+	mUsed += size;
+}
+
+void LuosExportFile::Flush()
+{
+	if( mUsed == 0 )
+		return;
+	AnalyzerHelpers::AppendToFile( mBuffer.get(), mUsed, mFile );
+	mUsed = 0;
+}
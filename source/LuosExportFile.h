@@ -0,0 +1,30 @@
+#ifndef LUOS_EXPORT_FILE
+#define LUOS_EXPORT_FILE
+
+#include <LogicPublicTypes.h>
+#include <memory>
+
+#define LUOS_EXPORT_BUFFER_SIZE ( 1 << 20 )
+
+/*Export file written with the sdk file functions in blocks of LUOS_EXPORT_BUFFER_SIZE bytes:
+rows are appended to the buffer and the file is only written when it is full, there is no flush per row*/
+class LuosExportFile
+{
+public:
+	LuosExportFile( const char* file_name, bool is_binary = false );
+	//writes what is left in the buffer and closes the file
+	~LuosExportFile();
+
+	void Write( const void* data, U32 size );
+	void Flush();
+	//bytes written since the beginning of the file
+	U64 GetOffset() const { return mOffset; }
+
+protected:
+	void* mFile;
+	std::unique_ptr< U8[] > mBuffer;
+	U32 mUsed;
+	U64 mOffset;
+};
+
+#endif //LUOS_EXPORT_FILE
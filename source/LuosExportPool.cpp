@@ -0,0 +1,72 @@
+#include "LuosExportPool.h"
+
+LuosExportPool::LuosExportPool( const Format& format )
+:	mFormat( format ),
+	mStop( false )
+{
+	U32 threads = std::thread::hardware_concurrency();
+	if( threads == 0 )
+		threads = 1;
+	mWindow = threads * LUOS_EXPORT_CHUNKS_PER_THREAD;
+	mTexts.resize( mWindow );
+	mFormatted.resize( mWindow, 0 );
+	for( U32 i = 0; i < threads; i++ )
+		mThreads.push_back( std::thread( &LuosExportPool::Run, this ) );
+}
+
+LuosExportPool::~LuosExportPool()
+{
+	{
+		std::lock_guard< std::mutex > lock( mMutex );
+		mStop = true;
+		mQueue.clear();
+	}
+	mWork.notify_all();
+	for( U32 i = 0; i < mThreads.size(); i++ )
+		mThreads[ i ].join();
+}
+
+void LuosExportPool::Submit( U64 chunk )
+{
+	{
+		std::lock_guard< std::mutex > lock( mMutex );
+		mFormatted[ chunk % mWindow ] = 0;
+		mQueue.push_back( chunk );
+	}
+	mWork.notify_one();
+}
+
+const std::string& LuosExportPool::Wait( U64 chunk )
+{
+	U32 slot = U32( chunk % mWindow );
+	std::unique_lock< std::mutex > lock( mMutex );
+	mDone.wait( lock, [ this, slot, chunk ] { return mFormatted[ slot ] == chunk + 1; } );
+	return mTexts[ slot ];
+}
+
+void LuosExportPool::Run()
+{
+	for( ;; )
+	{
+		U64 chunk;
+		{
+			std::unique_lock< std::mutex > lock( mMutex );
+			mWork.wait( lock, [ this ] { return mStop || !mQueue.empty(); } );
+			if( mStop )
+				return;
+			chunk = mQueue.front();
+			mQueue.pop_front();
+		}
+
+		//the slot is only used by this chunk until it is written
+		U32 slot = U32( chunk % mWindow );
+		mTexts[ slot ].clear();
+		mFormat( slot, chunk, mTexts[ slot ] );
+
+		{
+			std::lock_guard< std::mutex > lock( mMutex );
+			mFormatted[ slot ] = chunk + 1;
+		}
+		mDone.notify_all();
+	}
+}
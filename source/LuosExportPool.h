@@ -0,0 +1,52 @@
+#ifndef LUOS_EXPORT_POOL
+#define LUOS_EXPORT_POOL
+
+#include <LogicPublicTypes.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//frames or msgs formatted per chunk
+#define LUOS_EXPORT_CHUNK_SIZE 8192
+//chunks in flight per thread: the pool stays busy while the calling thread writes
+#define LUOS_EXPORT_CHUNKS_PER_THREAD 4
+
+/*Formats an export in chunks on a pool of threads, the calling thread writes the chunks in order.
+Chunk k uses slot k % GetWindow(): the caller prepares the data of the slot if the format needs any,
+submits the chunk, then waits for the oldest chunk in flight, writes its text and checks the cancel.
+Only the calling thread uses the sdk, the format functions only read what the slot and the message store hold.
+Destroying the pool drops the chunks not formatted yet and joins the threads: an export that is cancelled just returns*/
+class LuosExportPool
+{
+public:
+	//fills the text of a chunk, called on a pool thread
+	typedef std::function< void( U32 slot, U64 chunk, std::string& text ) > Format;
+
+	LuosExportPool( const Format& format );
+	~LuosExportPool();
+
+	U32 GetWindow() const { return mWindow; }
+	void Submit( U64 chunk );
+	//text of a chunk submitted before, valid until the chunk is submitted again
+	const std::string& Wait( U64 chunk );
+
+protected:
+	void Run();
+
+	Format mFormat;
+	U32 mWindow;
+	std::vector< std::string > mTexts;      //by slot, their memory is reused
+	std::vector< U64 > mFormatted;          //by slot: chunk + 1 formatted in it, 0: none
+	std::deque< U64 > mQueue;
+	bool mStop;
+	std::mutex mMutex;
+	std::condition_variable mWork;
+	std::condition_variable mDone;
+	std::vector< std::thread > mThreads;
+};
+
+#endif //LUOS_EXPORT_POOL
@@ -0,0 +1,64 @@
+#ifndef LUOS_HEADER
+#define LUOS_HEADER
+
+#include <LogicPublicTypes.h>
+
+#define LUOS_HEADER_SIZE 7
+
+//one field of the header: bits [mOffset, mOffset + mWidth) of the header bytes read as a little endian number
+struct LuosHeaderField
+{
+	U32 mLabel;     //frame label
+	U32 mOffset;
+	U32 mWidth;
+
+	constexpr U32 FirstByte() const { return mOffset / 8; }
+	constexpr U32 LastByte() const { return ( mOffset + mWidth - 1 ) / 8; }
+	//first bit of the field in its first byte, bit following the field in its last byte
+	constexpr U32 FirstBit() const { return mOffset % 8; }
+	constexpr U32 EndBit() const { return mOffset + mWidth - 8 * LastByte(); }
+	constexpr U64 Extract( U64 header ) const { return ( header >> mOffset ) & ( ( 1ULL << mWidth ) - 1 ); }
+};
+
+typedef enum { HEADER_PROTOCOL,
+			   HEADER_TARGET,
+			   HEADER_MODE,
+			   HEADER_SOURCE,
+			   HEADER_CMD,
+			   HEADER_SIZE,
+			   HEADER_FIELDS }header_field;
+
+//target modes of the MODE field
+typedef enum { MODE_ID,
+			   MODE_IDACK,
+			   MODE_TYPE,
+			   MODE_BROADCAST,
+			   MODE_MULTICAST,
+			   MODE_NODEID,
+			   MODE_NODEIDACK }target_mode;
+
+#define LUOS_ID_COUNT ( 1 << 12 )     //node and service ids are 12 bits
+#define LUOS_ASK_PUB_CMD 11
+
+//Luos header layout, fields in transmission order
+static constexpr LuosHeaderField LUOS_HEADER_LAYOUT[ HEADER_FIELDS ] = {
+	{ 'PROT', 0, 4 },
+	{ 'TRGT', 4, 12 },
+	{ 'MODE', 16, 4 },
+	{ 'SRC', 20, 12 },
+	{ 'CMD', 32, 8 },
+	{ 'SIZE', 40, 16 } };
+
+//header bytes read as a little endian number
+inline U64 LuosReadHeader( const U8* bytes )
+{
+	U64 header = 0;
+	for( U32 i = 0; i < LUOS_HEADER_SIZE; i++ )
+		header |= ( U64 )bytes[ i ] << ( 8 * i );
+	return header;
+}
+
+static_assert( LUOS_HEADER_LAYOUT[ HEADER_FIELDS - 1 ].mOffset + LUOS_HEADER_LAYOUT[ HEADER_FIELDS - 1 ].mWidth == 8 * LUOS_HEADER_SIZE,
+			   "the header layout must fill LUOS_HEADER_SIZE bytes" );
+
+#endif //LUOS_HEADER
@@ -0,0 +1,99 @@
+#include "LuosMessageStore.h"
+#include <string.h>
+#include <algorithm>
+
+LuosMessageStore::LuosMessageStore()
+:	mChunk( 0 ),
+	mChunkUsed( 0 )
+{
+}
+
+LuosMessageStore::~LuosMessageStore()
+{
+}
+
+void LuosMessageStore::Clear()
+{
+	std::lock_guard< std::mutex > lock( mMutex );
+	mChunk = 0;
+	mChunkUsed = 0;
+	mEntries.clear();
+	mTransfers.clear();
+}
+
+U64 LuosMessageStore::AddMessage( const U8* bytes, U32 size, const LuosMessageInfo& info )
+{
+	std::lock_guard< std::mutex > lock( mMutex );
+
+	//a msg is never split over two chunks
+	if( mChunks.empty() || mChunkUsed + size > LUOS_STORE_CHUNK_SIZE )
+	{
+		if( !mChunks.empty() )
+			mChunk++;
+		if( mChunk == mChunks.size() )
+			mChunks.push_back( std::unique_ptr< U8[] >( new U8[ LUOS_STORE_CHUNK_SIZE ] ) );
+		mChunkUsed = 0;
+	}
+
+	U8* destination = mChunks[ mChunk ].get() + mChunkUsed;
+	memcpy( destination, bytes, size );
+	mChunkUsed += size;
+
+	Entry entry = { destination, size, info };
+	mEntries.push_back( entry );
+	return mEntries.size() - 1;
+}
+
+U64 LuosMessageStore::GetNumMessages() const
+{
+	std::lock_guard< std::mutex > lock( mMutex );
+	return mEntries.size();
+}
+
+U32 LuosMessageStore::GetMessage( U64 message_id, const U8** bytes, LuosMessageInfo* info ) const
+{
+	std::lock_guard< std::mutex > lock( mMutex );
+	if( message_id >= mEntries.size() )
+		return 0;
+	*bytes = mEntries[ message_id ].mBytes;
+	if( info != NULL )
+		*info = mEntries[ message_id ].mInfo;
+	return mEntries[ message_id ].mSize;
+}
+
+U64 LuosMessageStore::AddTransfer( const LuosTransfer& transfer )
+{
+	std::lock_guard< std::mutex > lock( mMutex );
+	mTransfers.push_back( transfer );
+	return mTransfers.size() - 1;
+}
+
+void LuosMessageStore::SetTransfer( U64 transfer_id, const LuosTransfer& transfer )
+{
+	std::lock_guard< std::mutex > lock( mMutex );
+	mTransfers[ transfer_id ] = transfer;
+}
+
+U64 LuosMessageStore::GetNumTransfers() const
+{
+	std::lock_guard< std::mutex > lock( mMutex );
+	return mTransfers.size();
+}
+
+LuosTransfer LuosMessageStore::GetTransfer( U64 transfer_id ) const
+{
+	std::lock_guard< std::mutex > lock( mMutex );
+	return mTransfers[ transfer_id ];
+}
+
+bool LuosMessageStore::FindTransfer( U64 packet_id, LuosTransfer& transfer ) const
+{
+	std::lock_guard< std::mutex > lock( mMutex );
+	//stored in the order they start, so by first packet id
+	std::vector< LuosTransfer >::const_iterator found = std::lower_bound( mTransfers.begin(), mTransfers.end(), packet_id,
+		[]( const LuosTransfer& stored, U64 id ) { return stored.mFirstPacket < id; } );
+	if( found == mTransfers.end() || found->mFirstPacket != packet_id )
+		return false;
+	transfer = *found;
+	return true;
+}
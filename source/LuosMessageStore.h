@@ -0,0 +1,83 @@
+#ifndef LUOS_MESSAGE_STORE
+#define LUOS_MESSAGE_STORE
+
+#include <LogicPublicTypes.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#define LUOS_STORE_CHUNK_SIZE ( 1 << 20 )
+
+//a msg larger than the max data size is sent in fragments, the SIZE of each fragment is the size left to send
+struct LuosTransfer
+{
+	U64 mTransaction;       //transaction holding the fragments
+	U64 mFirstPacket;       //packet id of the first fragment
+	U16 mSource;
+	U16 mTarget;
+	U8 mCmd;
+	U32 mSize;              //SIZE of the first fragment, 0: no transfer
+	U32 mSent;              //payload bytes of the fragments seen, the SIZE of the next one is what is left
+	U32 mReceived;          //payload bytes received with a good crc
+	U32 mFragments;
+	bool mComplete;         //every byte was received with a good crc, false while the transfer is in flight
+	U64 mStartSample;       //start of the first fragment
+	U64 mEndSample;         //end of the last one
+};
+
+//what the decoder knows of a msg besides its bytes
+struct LuosMessageInfo
+{
+	U64 mStartSample;       //start of the first header byte
+	U64 mEndSample;         //end of the crc
+	U64 mAckSample;         //start of the ack
+	U16 mCrc;               //crc received
+	bool mCrcGood;
+	bool mAcked;            //an ack was received
+	U8 mAck;
+};
+
+/*Raw bytes (header + payload) and decoded info of every msg, next to the frames that can only hold 16 bytes.
+Msgs are appended in chunks of LUOS_STORE_CHUNK_SIZE bytes that never move: decoding does not allocate per msg
+and the bytes returned by GetMessage stay valid until the next Clear.
+Msg ids follow the packet ids: the msg of a packet is stored just before the packet is committed.
+The transfers reassembled from fragments are kept in the order they start*/
+class LuosMessageStore
+{
+public:
+	LuosMessageStore();
+	~LuosMessageStore();
+
+	//beginning of a new decoding, the chunks are kept for it
+	void Clear();
+	U64 AddMessage( const U8* bytes, U32 size, const LuosMessageInfo& info );
+
+	U64 GetNumMessages() const;
+	//returns the size of the msg, 0 if it is not stored
+	U32 GetMessage( U64 message_id, const U8** bytes, LuosMessageInfo* info = NULL ) const;
+
+	//a transfer is stored at its first fragment and updated with the next ones: one still in flight when the capture ends is kept
+	U64 AddTransfer( const LuosTransfer& transfer );
+	void SetTransfer( U64 transfer_id, const LuosTransfer& transfer );
+	U64 GetNumTransfers() const;
+	LuosTransfer GetTransfer( U64 transfer_id ) const;
+	//transfer whose first fragment is the packet, false if none starts with it
+	bool FindTransfer( U64 packet_id, LuosTransfer& transfer ) const;
+
+protected:
+	struct Entry
+	{
+		const U8* mBytes;
+		U32 mSize;
+		LuosMessageInfo mInfo;
+	};
+
+	std::vector< std::unique_ptr< U8[] > > mChunks;
+	U32 mChunk;         //chunk being filled
+	U32 mChunkUsed;     //bytes used in it
+	std::vector< Entry > mEntries;
+	std::vector< LuosTransfer > mTransfers;
+	mutable std::mutex mMutex;      //the decoder adds while the results read
+};
+
+#endif //LUOS_MESSAGE_STORE
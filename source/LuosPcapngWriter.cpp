@@ -0,0 +1,98 @@
+#include "LuosPcapngWriter.h"
+#include "LuosDecoderContext.h"
+#include <string.h>
+
+#define PCAPNG_SECTION_HEADER 0x0A0D0D0A
+#define PCAPNG_INTERFACE_DESCRIPTION 0x00000001
+#define PCAPNG_ENHANCED_PACKET 0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1A2B3C4D
+#define PCAPNG_IF_TSRESOL 9
+#define PCAPNG_EPB_SIZE 32     //enhanced packet block without its data
+#define LUOS_PCAPNG_MAX_PACKET ( LUOS_PCAPNG_PSEUDO_HEADER_SIZE + LUOS_HEADER_SIZE + LUOS_MAX_DATA_SIZE + 2 )
+
+//little endian whatever the host
+static U8* Put16( U8* out, U32 value )
+{
+	out[ 0 ] = U8( value );
+	out[ 1 ] = U8( value >> 8 );
+	return out + 2;
+}
+
+static U8* Put32( U8* out, U32 value )
+{
+	return Put16( Put16( out, value ), value >> 16 );
+}
+
+LuosPcapngWriter::LuosPcapngWriter( const char* file_name, U32 sample_rate )
+:	mFile( file_name, true ),
+	mSampleRate( sample_rate )
+{
+	U8 blocks[ 28 + 32 ];
+	U8* out = blocks;
+
+	//section header block, no option, section length unknown
+	out = Put32( out, PCAPNG_SECTION_HEADER );
+	out = Put32( out, 28 );
+	out = Put32( out, PCAPNG_BYTE_ORDER_MAGIC );
+	out = Put16( out, 1 );
+	out = Put16( out, 0 );
+	out = Put32( out, 0xFFFFFFFF );
+	out = Put32( out, 0xFFFFFFFF );
+	out = Put32( out, 28 );
+
+	//interface description block: the link type and if_tsresol = 10^-9 s
+	out = Put32( out, PCAPNG_INTERFACE_DESCRIPTION );
+	out = Put32( out, 32 );
+	out = Put16( out, LUOS_PCAPNG_LINKTYPE );
+	out = Put16( out, 0 );
+	out = Put32( out, 0 );                      //no snap length
+	out = Put16( out, PCAPNG_IF_TSRESOL );
+	out = Put16( out, 1 );
+	out = Put32( out, 9 );                      //resolution then padding
+	out = Put32( out, 0 );                      //end of options
+	out = Put32( out, 32 );
+
+	mFile.Write( blocks, U32( out - blocks ) );
+}
+
+LuosPcapngWriter::~LuosPcapngWriter()
+{
+}
+
+void LuosPcapngWriter::AddMessage( const U8* bytes, U32 size, const LuosMessageInfo& info )
+{
+	U8 block[ PCAPNG_EPB_SIZE + LUOS_PCAPNG_MAX_PACKET + 3 ];
+	U32 packet_size = LUOS_PCAPNG_PSEUDO_HEADER_SIZE + size + 2;
+	U32 padded_size = ( packet_size + 3 ) & ~3u;
+	U32 block_size = PCAPNG_EPB_SIZE + padded_size;
+	U64 timestamp = Nanoseconds( info.mStartSample );
+	U64 ack_latency = info.mAcked && info.mAckSample > info.mEndSample ? Nanoseconds( info.mAckSample - info.mEndSample ) : 0;
+
+	U8* out = block;
+	out = Put32( out, PCAPNG_ENHANCED_PACKET );
+	out = Put32( out, block_size );
+	out = Put32( out, 0 );                      //interface
+	out = Put32( out, U32( timestamp >> 32 ) );
+	out = Put32( out, U32( timestamp ) );
+	out = Put32( out, packet_size );
+	out = Put32( out, packet_size );
+
+	*out++ = LUOS_PCAPNG_VERSION;
+	*out++ = U8( ( info.mCrcGood ? LUOS_PCAPNG_CRC_GOOD : 0 ) | ( info.mAcked ? LUOS_PCAPNG_ACKED : 0 ) );
+	*out++ = info.mAck;
+	*out++ = 0;
+	out = Put32( out, ack_latency > 0xFFFFFFFF ? 0xFFFFFFFF : U32( ack_latency ) );
+	memcpy( out, bytes, size );
+	out = Put16( out + size, info.mCrc );
+	memset( out, 0, padded_size - packet_size );
+	out += padded_size - packet_size;
+
+	out = Put32( out, block_size );
+	mFile.Write( block, block_size );
+}
+
+//integer arithmetic, exact for any capture length
+U64 LuosPcapngWriter::Nanoseconds( U64 samples ) const
+{
+	return ( samples / mSampleRate ) * 1000000000ull + ( samples % mSampleRate ) * 1000000000ull / mSampleRate;
+}
@@ -0,0 +1,39 @@
+#ifndef LUOS_PCAPNG_WRITER
+#define LUOS_PCAPNG_WRITER
+
+#include "LuosExportFile.h"
+#include "LuosMessageStore.h"
+
+//link type of the packets, LINKTYPE_USER0: Wireshark decodes it with wireshark/luos.lua
+#define LUOS_PCAPNG_LINKTYPE 147
+
+/*Packet of a msg, little endian:
+	U8  version         LUOS_PCAPNG_VERSION
+	U8  flags           LUOS_PCAPNG_CRC_GOOD | LUOS_PCAPNG_ACKED
+	U8  ack             ack received
+	U8  reserved
+	U32 ack latency     start of the ack - end of the crc, ns
+	the bytes of the msg: header, payload, then the crc received*/
+#define LUOS_PCAPNG_VERSION 1
+#define LUOS_PCAPNG_PSEUDO_HEADER_SIZE 8
+#define LUOS_PCAPNG_CRC_GOOD 0x01
+#define LUOS_PCAPNG_ACKED 0x02
+
+/*Writes the msgs as a pcapng file: a section header, one interface with ns timestamps, then an enhanced packet block per msg.
+The timestamps are the ns from the first sample of the capture*/
+class LuosPcapngWriter
+{
+public:
+	LuosPcapngWriter( const char* file_name, U32 sample_rate );
+	~LuosPcapngWriter();
+
+	void AddMessage( const U8* bytes, U32 size, const LuosMessageInfo& info );
+
+protected:
+	U64 Nanoseconds( U64 samples ) const;
+
+	LuosExportFile mFile;
+	U32 mSampleRate;
+};
+
+#endif //LUOS_PCAPNG_WRITER
@@ -0,0 +1,89 @@
+-- Wireshark dissector of the pcapng files exported by the Luos analyzer ("Export messages as pcapng file").
+-- Install: copy this file in the Wireshark personal Lua plugins folder (Help > About Wireshark > Folders).
+-- The packets use LINKTYPE_USER0 (147), see LuosPcapngWriter.h for their layout:
+--   version, flags, ack, reserved, ack latency (ns), then the msg bytes: header, payload, crc.
+-- Filter examples: luos.source == 2, luos.cmd == 11, !luos.crc_good, luos.ack_latency > 5000
+
+local luos = Proto("luos", "Luos")
+
+local mode_names = {
+	[0] = "ID", [1] = "IDACK", [2] = "TYPE", [3] = "BROADCAST", [4] = "MULTICAST", [5] = "NODEID", [6] = "NODEIDACK"
+}
+
+local cmd_names = {
+	[0] = "WRITE_NODE_ID", [1] = "RESET_DETECTION", [2] = "SET_BAUDRATE", [3] = "ASSERT", [4] = "RTB_CMD",
+	[5] = "WRITE_ALIAS", [6] = "UPDATE_PUB", [7] = "NODE_UUID", [8] = "REVISION", [9] = "LUOS_REVISION",
+	[10] = "LUOS_STATISTICS", [11] = "ASK_PUB_CMD", [12] = "COLOR", [13] = "COMPLIANT", [14] = "IO_STATE",
+	[15] = "RATIO", [16] = "PEDOMETER", [17] = "ILLUMINANCE", [18] = "VOLTAGE", [19] = "CURRENT",
+	[20] = "POWER", [21] = "TEMPERATURE", [22] = "TIME", [23] = "FORCE", [24] = "MOMENT", [25] = "CONTROL",
+	[26] = "REGISTER", [27] = "REINIT", [28] = "PID", [29] = "RESOLUTION", [30] = "REDUCTION",
+	[31] = "DIMENSION", [32] = "OFFSET", [33] = "SETID", [34] = "ANGULAR_POSITION", [35] = "ANGULAR_SPEED",
+	[36] = "LINEAR_POSITION", [37] = "LINEAR_SPEED", [38] = "ACCEL_3D", [39] = "GYRO_3D", [40] = "QUATERNION",
+	[41] = "COMPASS_3D", [42] = "EULER_3D", [43] = "ROT_MAT", [44] = "LINEAR_ACCEL", [45] = "GRAVITY_VECTOR",
+	[46] = "HEADING", [47] = "ANGULAR_POSITION_LIMIT", [48] = "LINEAR_POSITION_LIMIT", [49] = "RATIO_LIMIT",
+	[50] = "CURRENT_LIMIT", [51] = "ANGULAR_SPEED_LIMIT", [52] = "LINEAR_SPEED_LIMIT", [53] = "TORQUE_LIMIT",
+	[54] = "DXL_WHEELMODE", [55] = "HANDY_SET_POSITION", [56] = "PARAMETERS", [57] = "LUOS_PROTOCOL_NB"
+}
+
+local f = luos.fields
+f.version = ProtoField.uint8("luos.version", "Export version")
+f.crc_good = ProtoField.bool("luos.crc_good", "CRC good", 8, nil, 0x01)
+f.acked = ProtoField.bool("luos.acked", "Acked", 8, nil, 0x02)
+f.ack = ProtoField.uint8("luos.ack", "Ack", base.HEX)
+f.ack_latency = ProtoField.uint32("luos.ack_latency", "Ack latency (ns)")
+f.protocol = ProtoField.uint16("luos.protocol", "Protocol", base.DEC, nil, 0x000F)
+f.target = ProtoField.uint16("luos.target", "Target", base.DEC, nil, 0xFFF0)
+f.mode = ProtoField.uint16("luos.mode", "Target mode", base.DEC, mode_names, 0x000F)
+f.source = ProtoField.uint16("luos.source", "Source", base.DEC, nil, 0xFFF0)
+f.cmd = ProtoField.uint8("luos.cmd", "Cmd", base.DEC, cmd_names)
+f.size = ProtoField.uint16("luos.size", "Size")
+f.payload = ProtoField.bytes("luos.payload", "Payload")
+f.crc = ProtoField.uint16("luos.crc", "CRC", base.HEX)
+
+local PSEUDO_HEADER_SIZE = 8
+local HEADER_SIZE = 7
+
+function luos.dissector(tvb, pinfo, tree)
+	if tvb:len() < PSEUDO_HEADER_SIZE + HEADER_SIZE + 2 then
+		return 0
+	end
+	pinfo.cols.protocol = "LUOS"
+
+	local root = tree:add(luos, tvb())
+	local flags = tvb(1, 1)
+	root:add(f.version, tvb(0, 1))
+	root:add(f.crc_good, flags)
+	root:add(f.acked, flags)
+	if math.floor(flags:uint() / 2) % 2 == 1 then
+		root:add(f.ack, tvb(2, 1))
+		root:add_le(f.ack_latency, tvb(4, 4))
+	end
+
+	-- the header is read as little endian 16 bit words, the fields are their bits
+	local header = tvb(PSEUDO_HEADER_SIZE, HEADER_SIZE)
+	local header_tree = root:add(header, "Header")
+	header_tree:add_le(f.protocol, header(0, 2))
+	header_tree:add_le(f.target, header(0, 2))
+	header_tree:add_le(f.mode, header(2, 2))
+	header_tree:add_le(f.source, header(2, 2))
+	header_tree:add(f.cmd, header(4, 1))
+	header_tree:add_le(f.size, header(5, 2))
+
+	local payload_size = tvb:len() - PSEUDO_HEADER_SIZE - HEADER_SIZE - 2
+	if payload_size > 0 then
+		root:add(f.payload, tvb(PSEUDO_HEADER_SIZE + HEADER_SIZE, payload_size))
+	end
+	root:add_le(f.crc, tvb(tvb:len() - 2, 2))
+
+	local target = math.floor(header(0, 2):le_uint() / 16)
+	local source = math.floor(header(2, 2):le_uint() / 16)
+	local cmd = header(4, 1):uint()
+	pinfo.cols.src = tostring(source)
+	pinfo.cols.dst = tostring(target)
+	pinfo.cols.info = string.format("%d -> %d %s %s, SIZE = %d%s", source, target,
+		mode_names[header(2, 2):le_uint() % 16] or "?", cmd_names[cmd] or tostring(cmd),
+		header(5, 2):le_uint(), flags:uint() % 2 == 1 and "" or ", CRC NOT GOOD")
+	return tvb:len()
+end
+
+DissectorTable.get("wtap_encap"):add(wtap.USER0, luos)